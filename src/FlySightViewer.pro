@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui printsupport webkitwidgets sql
+QT       += core gui printsupport webkitwidgets sql concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -23,10 +23,13 @@ SOURCES += main.cpp \
     configdialog.cpp \
     mapview.cpp \
     common.cpp \
+    atmosphere.cpp \
+    batchsimulator.cpp \
     videoview.cpp \
     windplot.cpp \
     liftdragplot.cpp \
     scoringview.cpp \
+    slopefilter.cpp \
     genome.cpp \
     orthoview.cpp \
     playbackview.cpp \
@@ -40,13 +43,30 @@ SOURCES += main.cpp \
     wideopendistancescoring.cpp \
     wideopenspeedscoring.cpp \
     geographicutil.cpp \
+    importtask.cpp \
     importworker.cpp \
+    logbookmodel.cpp \
+    logbookstore.cpp \
     logbookview.cpp \
     performancescoring.cpp \
     performanceform.cpp \
     flareform.cpp \
     flarescoring.cpp \
+    flysightreader.cpp \
+    channelcache.cpp \
+    minmaxpyramid.cpp \
+    optimizationdialog.cpp \
+    batchoptimizationdialog.cpp \
+    batchoptimizationworker.cpp \
+    optimizationworker.cpp \
+    optimizer.cpp \
+    geneticoptimizer.cpp \
+    differentialevolution.cpp \
     ppcupload.cpp \
+    randomstream.cpp \
+    trackcache.cpp \
+    trackdata.cpp \
+    trackprocessor.cpp \
     GeographicLib/Accumulator.cpp \
     GeographicLib/AlbersEqualArea.cpp \
     GeographicLib/AzimuthalEquidistant.cpp \
@@ -97,10 +117,13 @@ HEADERS  += mainwindow.h \
     configdialog.h \
     mapview.h \
     common.h \
+    atmosphere.h \
+    batchsimulator.h \
     videoview.h \
     windplot.h \
     liftdragplot.h \
     scoringview.h \
+    slopefilter.h \
     genome.h \
     orthoview.h \
     playbackview.h \
@@ -116,11 +139,28 @@ HEADERS  += mainwindow.h \
     wideopendistancescoring.h \
     wideopenspeedscoring.h \
     geographicutil.h \
+    importtask.h \
     importworker.h \
+    logbookmodel.h \
+    logbookstore.h \
     logbookview.h \
     flareform.h \
     flarescoring.h \
+    flysightreader.h \
+    channelcache.h \
+    minmaxpyramid.h \
+    optimizationdialog.h \
+    batchoptimizationdialog.h \
+    batchoptimizationworker.h \
+    optimizationworker.h \
+    optimizer.h \
+    geneticoptimizer.h \
+    differentialevolution.h \
     ppcupload.h \
+    randomstream.h \
+    trackcache.h \
+    trackdata.h \
+    trackprocessor.h \
     QCustomPlot/qcustomplot.h \
     secrets.h
 
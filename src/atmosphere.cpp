@@ -0,0 +1,71 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "atmosphere.h"
+
+#include <math.h>
+
+#include "common.h"
+
+namespace
+{
+
+// Built during static initialization so concurrent callers never race to
+// create it
+const Atmosphere standardAtmosphere;
+
+} // namespace
+
+Atmosphere::Atmosphere(
+        double temperatureOffset,
+        double pressureOffset):
+    mTemperatureOffset(temperatureOffset),
+    mPressureOffset(pressureOffset)
+{
+    const int n = (MAX_ALTITUDE - MIN_ALTITUDE) / STEP + 1;
+
+    mTable.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        mTable[i] = exactDensity(MIN_ALTITUDE + (double) i * STEP);
+    }
+}
+
+const Atmosphere &Atmosphere::standard()
+{
+    return standardAtmosphere;
+}
+
+double Atmosphere::exactDensity(
+        double hMSL) const
+{
+    // From https://en.wikipedia.org/wiki/Atmospheric_pressure#Altitude_variation
+    const double airPressure = (SL_PRESSURE + mPressureOffset) * pow(1 - LAPSE_RATE * hMSL / SL_TEMP, A_GRAVITY * MM_AIR / GAS_CONST / LAPSE_RATE);
+
+    // From https://en.wikipedia.org/wiki/Lapse_rate
+    const double temperature = SL_TEMP - LAPSE_RATE * hMSL + mTemperatureOffset;
+
+    // From https://en.wikipedia.org/wiki/Density_of_air
+    return airPressure / (GAS_CONST / MM_AIR) / temperature;
+}
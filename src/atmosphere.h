@@ -0,0 +1,76 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef ATMOSPHERE_H
+#define ATMOSPHERE_H
+
+#include <QVector>
+
+// Air density from the standard atmosphere, read from a table sampled
+// every 10 m between -1000 m and 12000 m and linearly interpolated. Within
+// that range the relative error against the closed-form density is below
+// 2e-7 for temperature offsets up to +/-30 K; outside it the closed form
+// is evaluated directly.
+//
+// A measured offset for the day can be given: the temperature offset (K)
+// is added at every altitude and the pressure offset (Pa) is added to sea
+// level pressure.
+class Atmosphere
+{
+public:
+    explicit Atmosphere(double temperatureOffset = 0,
+                        double pressureOffset = 0);
+
+    static const Atmosphere &standard();
+
+    double temperatureOffset() const { return mTemperatureOffset; }
+    double pressureOffset() const { return mPressureOffset; }
+
+    // Density (kg/m^3) at altitude above mean sea level (m)
+    double density(double hMSL) const
+    {
+        const double u = (hMSL - MIN_ALTITUDE) * (1. / STEP);
+        if (!(u >= 0 && u < mTable.size() - 1)) return exactDensity(hMSL);
+
+        const int i = (int) u;
+
+        const double *p = mTable.constData() + i;
+        return p[0] + (u - i) * (p[1] - p[0]);
+    }
+
+    double exactDensity(double hMSL) const;
+
+private:
+    enum {
+        MIN_ALTITUDE = -1000,   // Table range (m)
+        MAX_ALTITUDE = 12000,
+        STEP         = 10       // Table spacing (m)
+    };
+
+    double            mTemperatureOffset;
+    double            mPressureOffset;
+    QVector< double > mTable;
+};
+
+#endif // ATMOSPHERE_H
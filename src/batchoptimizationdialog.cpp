@@ -0,0 +1,219 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "batchoptimizationdialog.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QThread>
+#include <QVBoxLayout>
+
+#include "batchoptimizationworker.h"
+#include "scoringmethod.h"
+
+BatchOptimizationDialog::BatchOptimizationDialog(
+        ScoringMethod *method,
+        MainWindow *mainWindow,
+        MainWindow::ScoringMode mode,
+        BatchOptimizationWorker *worker,
+        QWidget *parent):
+    QDialog(parent),
+    mMethod(method),
+    mMainWindow(mainWindow),
+    mMode(mode),
+    mWorker(worker),
+    mThread(new QThread),
+    mFinished(false)
+{
+    setWindowTitle(tr("Optimize All"));
+    setAttribute(Qt::WA_DeleteOnClose);
+    setModal(false);
+
+    mLabel = new QLabel(tr("Initializing..."));
+    mProgressBar = new QProgressBar;
+    mProgressBar->setRange(0, mWorker->maximum());
+    mProgressBar->setValue(0);
+
+    mTable = new QTableWidget(mWorker->jobCount(), colLast);
+    mTable->setHorizontalHeaderLabels(QStringList()
+                                      << tr("Track")
+                                      << tr("Actual")
+                                      << tr("Optimal")
+                                      << tr("Actual / Optimal"));
+    mTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    mTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    mTable->verticalHeader()->hide();
+    mTable->horizontalHeader()->setStretchLastSection(true);
+
+    for (int i = 0; i < mWorker->jobCount(); ++i)
+    {
+        setText(i, Track, mWorker->trackName(i));
+        setText(i, Actual, tr("Waiting"));
+    }
+    mTable->resizeColumnsToContents();
+
+    mCloseButton = new QPushButton(tr("Abort"));
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(mCloseButton);
+
+    QVBoxLayout *layout = new QVBoxLayout;
+    layout->addWidget(mLabel);
+    layout->addWidget(mProgressBar);
+    layout->addWidget(mTable);
+    layout->addLayout(buttonLayout);
+    setLayout(layout);
+
+    resize(520, 360);
+
+    mWorker->moveToThread(mThread);
+
+    connect(mThread, SIGNAL(started()), mWorker, SLOT(run()));
+    connect(mWorker, SIGNAL(finished()), mThread, SLOT(quit()));
+
+    connect(mWorker, SIGNAL(progressChanged(int)),
+            this, SLOT(onProgressChanged(int)));
+    connect(mWorker, SIGNAL(jobStarted(int)),
+            this, SLOT(onJobStarted(int)));
+    connect(mWorker, SIGNAL(jobFinished(int, double, double, MainWindow::DataPoints)),
+            this, SLOT(onJobFinished(int, double, double, MainWindow::DataPoints)));
+    connect(mWorker, SIGNAL(finished()),
+            this, SLOT(onFinished()));
+
+    connect(mCloseButton, SIGNAL(clicked()), this, SLOT(reject()));
+}
+
+BatchOptimizationDialog::~BatchOptimizationDialog()
+{
+    // Only reached once the worker is done, or if it never started
+    mWorker->cancel();
+    mThread->wait();
+
+    delete mWorker;
+    delete mThread;
+}
+
+void BatchOptimizationDialog::start()
+{
+    show();
+    mThread->start();
+}
+
+void BatchOptimizationDialog::stop()
+{
+    mWorker->cancel();
+    mThread->wait();
+}
+
+void BatchOptimizationDialog::reject()
+{
+    if (mFinished || !mThread->isRunning())
+    {
+        QDialog::reject();
+        return;
+    }
+
+    // Stop after the current generation and keep the results so far
+    mWorker->cancel();
+
+    mLabel->setText(tr("Stopping..."));
+    mCloseButton->setEnabled(false);
+}
+
+void BatchOptimizationDialog::setText(
+        int row,
+        Column column,
+        const QString &text)
+{
+    QTableWidgetItem *item = mTable->item(row, column);
+    if (!item)
+    {
+        item = new QTableWidgetItem;
+        if (column != Track) item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        mTable->setItem(row, column, item);
+    }
+    item->setText(text);
+}
+
+void BatchOptimizationDialog::onProgressChanged(
+        int value)
+{
+    mProgressBar->setValue(value);
+}
+
+void BatchOptimizationDialog::onJobStarted(
+        int index)
+{
+    if (mCloseButton->isEnabled())
+    {
+        mLabel->setText(tr("Optimizing track %1 of %2...")
+                        .arg(index + 1).arg(mWorker->jobCount()));
+    }
+
+    setText(index, Actual, tr("Optimizing..."));
+    mTable->scrollToItem(mTable->item(index, Track));
+}
+
+void BatchOptimizationDialog::onJobFinished(
+        int index,
+        double actualScore,
+        double optimalScore,
+        const MainWindow::DataPoints &result)
+{
+    mMainWindow->saveOptimal(mWorker->trackName(index), mMode,
+                             actualScore, optimalScore, result);
+
+    setText(index, Actual, mMethod->scoreAsText(actualScore));
+    setText(index, Optimal, mMethod->scoreAsText(optimalScore));
+
+    if (optimalScore != 0)
+    {
+        setText(index, Ratio, QString("%1%").arg(actualScore / optimalScore * 100, 0, 'f', 1));
+    }
+}
+
+void BatchOptimizationDialog::onFinished()
+{
+    mThread->wait();
+    mFinished = true;
+
+    const bool stopped = !mCloseButton->isEnabled();
+
+    // Leave the summary up until the user closes it
+    for (int i = 0; i < mWorker->jobCount(); ++i)
+    {
+        if (mTable->item(i, Optimal) == 0) setText(i, Actual, tr("Skipped"));
+    }
+    mTable->resizeColumnsToContents();
+
+    mLabel->setText(stopped ? tr("Stopped.") : tr("Done."));
+    if (!stopped) mProgressBar->setValue(mProgressBar->maximum());
+    mCloseButton->setText(tr("Close"));
+    mCloseButton->setEnabled(true);
+}
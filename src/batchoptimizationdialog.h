@@ -0,0 +1,91 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef BATCHOPTIMIZATIONDIALOG_H
+#define BATCHOPTIMIZATIONDIALOG_H
+
+#include <QDialog>
+
+#include "mainwindow.h"
+
+class BatchOptimizationWorker;
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QTableWidget;
+class QThread;
+class ScoringMethod;
+
+// Progress and summary for a batch optimization. Each result is written to
+// the logbook as it arrives and listed next to the actual score. Takes
+// ownership of the worker and its thread.
+class BatchOptimizationDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    BatchOptimizationDialog(ScoringMethod *method, MainWindow *mainWindow,
+                            MainWindow::ScoringMode mode,
+                            BatchOptimizationWorker *worker,
+                            QWidget *parent = 0);
+    ~BatchOptimizationDialog();
+
+    void start();
+
+    // Cancels the batch and waits for the worker thread, for when the
+    // scoring method is about to go away
+    void stop();
+
+public slots:
+    void reject();
+
+private:
+    typedef enum {
+        Track, Actual, Optimal, Ratio, colLast
+    } Column;
+
+    ScoringMethod           *mMethod;
+    MainWindow              *mMainWindow;
+    MainWindow::ScoringMode  mMode;
+    BatchOptimizationWorker *mWorker;
+    QThread                 *mThread;
+
+    QLabel                  *mLabel;
+    QProgressBar            *mProgressBar;
+    QTableWidget            *mTable;
+    QPushButton             *mCloseButton;
+
+    bool                     mFinished;
+
+    void setText(int row, Column column, const QString &text);
+
+private slots:
+    void onProgressChanged(int value);
+    void onJobStarted(int index);
+    void onJobFinished(int index, double actualScore, double optimalScore,
+                       const MainWindow::DataPoints &result);
+    void onFinished();
+};
+
+#endif // BATCHOPTIMIZATIONDIALOG_H
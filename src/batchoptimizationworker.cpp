@@ -0,0 +1,104 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "batchoptimizationworker.h"
+
+#include <QMutexLocker>
+
+#include "scoringmethod.h"
+
+BatchOptimizationWorker::BatchOptimizationWorker(
+        ScoringMethod *method,
+        MainWindow::OptimizationEngine engine,
+        const QVector< Job > &jobs,
+        QObject *parent):
+    QObject(parent),
+    mMethod(method),
+    mEngine(engine),
+    mJobs(jobs),
+    mCanceled(false),
+    mProgressOffset(0)
+{
+    qRegisterMetaType< MainWindow::DataPoints >("MainWindow::DataPoints");
+}
+
+int BatchOptimizationWorker::maximum() const
+{
+    Optimizer *optimizer = Optimizer::create(mEngine);
+
+    int total = 0;
+    foreach (const Job &job, mJobs)
+    {
+        total += optimizer->maximum(job.params);
+    }
+
+    delete optimizer;
+    return total;
+}
+
+void BatchOptimizationWorker::cancel()
+{
+    QMutexLocker locker(&mMutex);
+    mCanceled = true;
+}
+
+bool BatchOptimizationWorker::canceled()
+{
+    QMutexLocker locker(&mMutex);
+    return mCanceled;
+}
+
+bool BatchOptimizationWorker::report(
+        int progress,
+        const Score &best)
+{
+    emit progressChanged(mProgressOffset + progress);
+    return !canceled();
+}
+
+void BatchOptimizationWorker::run()
+{
+    for (int i = 0; i < mJobs.size() && !canceled(); ++i)
+    {
+        const Job &job = mJobs[i];
+
+        emit jobStarted(i);
+
+        Optimizer *optimizer = Optimizer::create(mEngine);
+        const Score best = optimizer->optimize(mMethod, job.params, *this);
+        mProgressOffset += optimizer->maximum(job.params);
+        delete optimizer;
+
+        // A canceled run has no usable result
+        if (canceled()) break;
+
+        MainWindow::DataPoints result;
+        Optimizer::simulate(job.params, best.second, result);
+
+        emit jobFinished(i, mMethod->score(job.data), best.first, result);
+        emit progressChanged(mProgressOffset);
+    }
+
+    emit finished();
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef BATCHOPTIMIZATIONWORKER_H
+#define BATCHOPTIMIZATIONWORKER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "mainwindow.h"
+#include "optimizer.h"
+
+class ScoringMethod;
+
+// Optimizes a list of tracks one after another. Each run already spreads
+// its generations over every core, so running several at once would only
+// compete for the same threads.
+class BatchOptimizationWorker : public QObject, private Optimizer::Context
+{
+    Q_OBJECT
+
+public:
+    typedef struct {
+        QString                trackName;
+        MainWindow::DataPoints data;
+        Optimizer::Parameters  params;
+    } Job;
+
+    BatchOptimizationWorker(ScoringMethod *method,
+                            MainWindow::OptimizationEngine engine,
+                            const QVector< Job > &jobs,
+                            QObject *parent = 0);
+
+    int jobCount() const { return mJobs.size(); }
+    const QString &trackName(int index) const { return mJobs[index].trackName; }
+
+    int maximum() const;
+
+    // Thread-safe; may be called from any thread
+    void cancel();
+
+public slots:
+    void run();
+
+signals:
+    void progressChanged(int value);
+    void jobStarted(int index);
+    void jobFinished(int index, double actualScore, double optimalScore,
+                     const MainWindow::DataPoints &result);
+    void finished();
+
+private:
+    ScoringMethod                 *mMethod;
+    MainWindow::OptimizationEngine mEngine;
+    QVector< Job >                 mJobs;
+
+    QMutex                         mMutex;
+    bool                           mCanceled;
+
+    int                            mProgressOffset;
+
+    bool report(int progress, const Score &best);
+    bool canceled();
+};
+
+#endif // BATCHOPTIMIZATIONWORKER_H
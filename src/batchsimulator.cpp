@@ -0,0 +1,253 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "batchsimulator.h"
+
+#include <math.h>
+
+#include "atmosphere.h"
+#include "common.h"
+#include "genome.h"
+
+BatchSimulator::BatchSimulator(
+        double h,
+        double a,
+        double c,
+        double planformArea,
+        double mass,
+        const DataPoint &dp0,
+        double windowBottom):
+    mH(h),
+    mA(a),
+    mC(c),
+    mPlanformArea(planformArea),
+    mMass(mass),
+    mDp0(dp0),
+    mWindowBottom(windowBottom)
+{
+
+}
+
+void BatchSimulator::resize(
+        int count)
+{
+    mTheta.resize(count);
+    mV.resize(count);
+    mX.resize(count);
+    mY.resize(count);
+    mDist2D.resize(count);
+    mDist3D.resize(count);
+
+    for (int s = 0; s < 4; ++s)
+    {
+        mK[s].resize(count);
+        mL[s].resize(count);
+        mM[s].resize(count);
+        mN[s].resize(count);
+    }
+
+    mLiftPrev.resize(count);
+    mDragPrev.resize(count);
+    mLiftNext.resize(count);
+    mDragNext.resize(count);
+    mRho.resize(count);
+    mActive.resize(count);
+}
+
+void BatchSimulator::simulate(
+        const Genome * const *genomes,
+        int count,
+        MainWindow::DataPoints *results)
+{
+    if (count <= 0) return;
+
+    resize(count);
+
+    const double h = mH;
+    const double a = mA;
+    const double c = mC;
+    const double planformArea = mPlanformArea;
+    const double mass = mMass;
+    const DataPoint &dp0 = mDp0;
+
+    const int size = genomes[0]->size();
+
+    const double velH = sqrt(dp0.vx * dp0.vx + dp0.vy * dp0.vy);
+    const double theta0 = atan2(-dp0.velD, velH);
+    const double v0 = sqrt(dp0.velD * dp0.velD + velH * velH);
+
+    double *theta = mTheta.data(), *v = mV.data(), *x = mX.data(), *y = mY.data();
+    double *dist2D = mDist2D.data(), *dist3D = mDist3D.data();
+    double *liftPrev = mLiftPrev.data(), *dragPrev = mDragPrev.data();
+    double *liftNext = mLiftNext.data(), *dragNext = mDragNext.data();
+    double *rho = mRho.data();
+    char *active = mActive.data();
+
+    double *k[4], *l[4], *m[4], *n[4];
+    for (int s = 0; s < 4; ++s)
+    {
+        k[s] = mK[s].data();
+        l[s] = mL[s].data();
+        m[s] = mM[s].data();
+        n[s] = mN[s].data();
+    }
+
+    QVector< const double * > genes(count);
+    QVector< DataPoint * > out(count);
+
+    for (int j = 0; j < count; ++j)
+    {
+        theta[j]  = theta0;
+        v[j]      = v0;
+        x[j]      = 0;
+        y[j]      = dp0.hMSL;
+        dist2D[j] = dp0.dist2D;
+        dist3D[j] = dp0.dist3D;
+        active[j] = true;
+
+        genes[j] = genomes[j]->constData();
+
+        // Reserving keeps the allocation when trimmed below
+        MainWindow::DataPoints &result = results[j];
+        result.reserve(qMax(size, 1));
+        result.resize(qMax(size, 1));
+
+        out[j] = result.data();
+        *out[j]++ = dp0;
+    }
+
+    const Atmosphere &atmosphere = Atmosphere::standard();
+
+    double t = dp0.t;
+    int numActive = count;
+
+    for (int i = 0; i + 1 < size && numActive > 0; ++i)
+    {
+        for (int j = 0; j < count; ++j)
+        {
+            const double clPrev = genes[j][i];
+            const double clNext = genes[j][i + 1];
+
+            liftPrev[j] = clPrev;
+            dragPrev[j] = a * clPrev * clPrev + c;
+            liftNext[j] = clNext;
+            dragNext[j] = a * clNext * clNext + c;
+        }
+
+        // Runge-Kutta integration, one stage at a time across all lanes.
+        // See https://en.wikipedia.org/wiki/Runge%E2%80%93Kutta_methods
+        for (int s = 0; s < 4; ++s)
+        {
+            // Stage s is evaluated at an offset along stage s - 1
+            const double *kp = k[s > 0 ? s - 1 : 0];
+            const double *lp = l[s > 0 ? s - 1 : 0];
+            const double *np = n[s > 0 ? s - 1 : 0];
+
+            for (int j = 0; j < count; ++j)
+            {
+                const double ys = (s == 0) ? y[j] : (s == 3) ? y[j] + np[j] : y[j] + np[j]/2;
+                rho[j] = atmosphere.density(ys);
+            }
+
+            for (int j = 0; j < count; ++j)
+            {
+                const double ts = (s == 0) ? theta[j] : (s == 3) ? theta[j] + kp[j] : theta[j] + kp[j]/2;
+                const double vs = (s == 0) ? v[j]     : (s == 3) ? v[j] + lp[j]     : v[j] + lp[j]/2;
+
+                const double cl = (s == 0) ? liftPrev[j] : (s == 3) ? liftNext[j] : (liftPrev[j] + liftNext[j]) / 2;
+                const double cd = (s == 0) ? dragPrev[j] : (s == 3) ? dragNext[j] : (dragPrev[j] + dragNext[j]) / 2;
+
+                const double cosTheta = cos(ts);
+                const double sinTheta = sin(ts);
+
+                // From https://en.wikipedia.org/wiki/Dynamic_pressure
+                const double dynamicPressure = rho[j] * vs * vs / 2;
+
+                const double accelLift = dynamicPressure * planformArea * cl / mass;
+                const double accelDrag = dynamicPressure * planformArea * cd / mass;
+
+                k[s][j] = h * ((accelLift - A_GRAVITY * cosTheta) / vs);
+                l[s][j] = h * (-accelDrag - A_GRAVITY * sinTheta);
+                m[s][j] = h * (vs * cosTheta);
+                n[s][j] = h * (vs * sinTheta);
+            }
+        }
+
+        t += h;
+
+        for (int j = 0; j < count; ++j)
+        {
+            const double dtheta = (k[0][j] + 2 * k[1][j] + 2 * k[2][j] + k[3][j]) / 6;
+            const double dv     = (l[0][j] + 2 * l[1][j] + 2 * l[2][j] + l[3][j]) / 6;
+            const double dx     = (m[0][j] + 2 * m[1][j] + 2 * m[2][j] + m[3][j]) / 6;
+            const double dy     = (n[0][j] + 2 * n[1][j] + 2 * n[2][j] + n[3][j]) / 6;
+
+            theta[j] += dtheta;
+            v[j]     += dv;
+            x[j]     += dx;
+            y[j]     += dy;
+
+            dist2D[j] += dx;
+            dist3D[j] += sqrt(dx * dx + dy * dy);
+        }
+
+        // Write output for lanes still above the window
+        for (int j = 0; j < count; ++j)
+        {
+            if (!active[j]) continue;
+
+            DataPoint &pt = *out[j]++;
+
+            pt.hasGeodetic = false;
+
+            pt.hMSL  = y[j];
+
+            pt.vx    = 0;
+            pt.vy    = v[j] * cos(theta[j]);
+            pt.velD  = -v[j] * sin(theta[j]);
+
+            pt.t = t;
+            pt.x = x[j];
+            pt.y = 0;
+            pt.z = y[j] + dp0.z - dp0.hMSL;
+
+            pt.dist2D = dist2D[j];
+            pt.dist3D = dist3D[j];
+
+            pt.lift = liftNext[j];
+            pt.drag = dragNext[j];
+
+            if (pt.z < mWindowBottom)
+            {
+                active[j] = false;
+                --numActive;
+            }
+        }
+    }
+
+    for (int j = 0; j < count; ++j)
+    {
+        results[j].resize(out[j] - results[j].constData());
+    }
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef BATCHSIMULATOR_H
+#define BATCHSIMULATOR_H
+
+#include <QVector>
+
+#include "datapoint.h"
+#include "mainwindow.h"
+
+class Genome;
+
+// Integrates several genomes of the same length in lockstep. State is kept
+// as one array per variable with one element per lane, so each stage of
+// the Runge-Kutta step is a plain loop over lanes. Lanes that have crossed
+// the bottom of the window stop producing output but are otherwise carried
+// along until every lane is done.
+//
+// Each result matches Genome::simulate for the same genome.
+class BatchSimulator
+{
+public:
+    BatchSimulator(double h, double a, double c,
+                   double planformArea, double mass,
+                   const DataPoint &dp0, double windowBottom);
+
+    void simulate(const Genome * const *genomes, int count,
+                  MainWindow::DataPoints *results);
+
+private:
+    double            mH;
+    double            mA, mC;
+    double            mPlanformArea;
+    double            mMass;
+    DataPoint         mDp0;
+    double            mWindowBottom;
+
+    QVector< double > mTheta, mV, mX, mY;
+    QVector< double > mDist2D, mDist3D;
+    QVector< double > mK[4], mL[4], mM[4], mN[4];
+    QVector< double > mLiftPrev, mDragPrev, mLiftNext, mDragNext;
+    QVector< double > mRho;
+    QVector< char >   mActive;
+
+    void resize(int count);
+};
+
+#endif // BATCHSIMULATOR_H
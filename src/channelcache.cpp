@@ -0,0 +1,76 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "channelcache.h"
+
+ChannelCache::ChannelCache():
+    mUnits(PlotValue::Metric)
+{
+
+}
+
+const QVector< double > &ChannelCache::values(
+        const TrackData &track,
+        const QVector< DataPoint > &data,
+        const PlotValue *value,
+        PlotValue::Units units)
+{
+    if (units != mUnits)
+    {
+        mValues.clear();
+        mUnits = units;
+    }
+
+    QMap< const PlotValue*, QVector< double > >::iterator p = mValues.find(value);
+    if (p != mValues.end()) return p.value();
+
+    const double factor = value->factor(units);
+
+    QVector< double > result(track.size());
+    double *dst = result.data();
+
+    if (value->channel() >= 0)
+    {
+        // Scale the stored channel directly
+        const double *src = track.constData((TrackData::Channel) value->channel());
+        for (int i = 0; i < track.size(); ++i)
+        {
+            dst[i] = src[i] * factor;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < track.size(); ++i)
+        {
+            dst[i] = value->rawValue(data[i]) * factor;
+        }
+    }
+
+    return mValues.insert(value, result).value();
+}
+
+void ChannelCache::clear()
+{
+    mValues.clear();
+}
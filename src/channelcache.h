@@ -0,0 +1,53 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef CHANNELCACHE_H
+#define CHANNELCACHE_H
+
+#include <QMap>
+#include <QVector>
+
+#include "datapoint.h"
+#include "plotvalue.h"
+#include "trackdata.h"
+
+// Values of each plot for every sample of a track, already scaled to the
+// display units. Arrays are filled on first use and kept until cleared.
+class ChannelCache
+{
+public:
+    ChannelCache();
+
+    const QVector< double > &values(const TrackData &track,
+                                    const QVector< DataPoint > &data,
+                                    const PlotValue *value,
+                                    PlotValue::Units units);
+    void clear();
+
+private:
+    QMap< const PlotValue*, QVector< double > > mValues;
+    PlotValue::Units                            mUnits;
+};
+
+#endif // CHANNELCACHE_H
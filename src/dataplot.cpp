@@ -21,8 +21,11 @@
 **  Website: http://flysight.ca/                                          **
 ****************************************************************************/
 
+#include <QDateTime>
 #include <QToolTip>
 
+#include <math.h>
+
 #include "dataplot.h"
 #include "mainwindow.h"
 
@@ -31,7 +34,11 @@ DataPlot::DataPlot(QWidget *parent) :
     mMainWindow(0),
     m_dragging(false),
     m_xAxisType(Time),
-    m_cursorValid(false)
+    m_cursorValid(false),
+    mCursorShading(0),
+    mCursorBegin(0),
+    mCursorLine(0),
+    mCursorCrosshair(0)
 {
     // Initialize window
     setMouseTracking(true);
@@ -255,6 +262,14 @@ void DataPlot::wheelEvent(
     }
 }
 
+void DataPlot::resizeEvent(
+        QResizeEvent *event)
+{
+    // Resample for the new width before the queued replot
+    updateTrackGraphs();
+    QCustomPlot::resizeEvent(event);
+}
+
 void DataPlot::leaveEvent(
         QEvent *)
 {
@@ -275,25 +290,28 @@ void DataPlot::setMark(
     DataPoint dpStart = interpolateDataX(start);
     DataPoint dpEnd = interpolateDataX(end);
 
+    const QDateTime dtStart = QDateTime::fromMSecsSinceEpoch(dpStart.timestamp, Qt::UTC);
+    const QDateTime dtEnd = QDateTime::fromMSecsSinceEpoch(dpEnd.timestamp, Qt::UTC);
+
     QString status;
-    if (dpStart.dateTime.date() == dpEnd.dateTime.date())
+    if (dtStart.date() == dtEnd.date())
     {
         status = QString("<p style='color:black;' align='center'><u>%1 %2.%3 to %4.%5 UTC</u></p>")
-                .arg(dpStart.dateTime.toUTC().date().toString(Qt::ISODate))
-                .arg(dpStart.dateTime.toUTC().time().toString(Qt::ISODate))
-                .arg(QString("%1").arg(dpStart.dateTime.time().msec(), 3, 10, QChar('0')))
-                .arg(dpEnd.dateTime.toUTC().time().toString(Qt::ISODate))
-                .arg(QString("%1").arg(dpEnd.dateTime.time().msec(), 3, 10, QChar('0')));
+                .arg(dtStart.date().toString(Qt::ISODate))
+                .arg(dtStart.time().toString(Qt::ISODate))
+                .arg(QString("%1").arg(dtStart.time().msec(), 3, 10, QChar('0')))
+                .arg(dtEnd.time().toString(Qt::ISODate))
+                .arg(QString("%1").arg(dtEnd.time().msec(), 3, 10, QChar('0')));
     }
     else
     {
         status = QString("<p style='color:black;' align='center'><u>%1 %2.%3 to %4 %5.%6 UTC</u></p>")
-                .arg(dpStart.dateTime.toUTC().date().toString(Qt::ISODate))
-                .arg(dpStart.dateTime.toUTC().time().toString(Qt::ISODate))
-                .arg(QString("%1").arg(dpStart.dateTime.time().msec(), 3, 10, QChar('0')))
-                .arg(dpEnd.dateTime.toUTC().date().toString(Qt::ISODate))
-                .arg(dpEnd.dateTime.toUTC().time().toString(Qt::ISODate))
-                .arg(QString("%1").arg(dpEnd.dateTime.time().msec(), 3, 10, QChar('0')));
+                .arg(dtStart.date().toString(Qt::ISODate))
+                .arg(dtStart.time().toString(Qt::ISODate))
+                .arg(QString("%1").arg(dtStart.time().msec(), 3, 10, QChar('0')))
+                .arg(dtEnd.date().toString(Qt::ISODate))
+                .arg(dtEnd.time().toString(Qt::ISODate))
+                .arg(QString("%1").arg(dtEnd.time().msec(), 3, 10, QChar('0')));
     }
 
     status += QString("<table width='400'>");
@@ -339,51 +357,51 @@ void DataPlot::setMark(
     const DataPoint &dpMin = mMainWindow->dataPoint(jMin);
     const DataPoint &dpMax = mMainWindow->dataPoint(jMax);
 
+    // Samples jMin through jMax come from the summaries; when the
+    // selection falls between two samples that range is just jMax
+    const int first = qMin(jMin, jMax);
+
+    int k = 0;
     for (int i = 0; i < yaLast; ++i)
     {
         if (yValue(i)->visible())
         {
+            const Integral &integral = mTrackIntegrals[k];
+            const MinMaxPyramid &pyramid = mTrackPyramids[k];
+            ++k;
+
+            const double yLow = yValue(i)->value(dpLow, mMainWindow->units());
+            const double yHigh = yValue(i)->value(dpHigh, mMainWindow->units());
+
             double dx = m_xValues[Time]->value(dpMin, mMainWindow->units())
                     - m_xValues[Time]->value(dpLow, mMainWindow->units());
-            double avg = (yValue(i)->value(dpMin, mMainWindow->units())
-                    + yValue(i)->value(dpLow, mMainWindow->units())) / 2;
+            double avg = (yValue(i)->value(dpMin, mMainWindow->units()) + yLow) / 2;
 
             double sum = avg * fabs(dx);
             double dxSum = fabs(dx);
 
-            double min = yValue(i)->value(dpLow, mMainWindow->units());
-            double max = min;
-
-            for (int j = jMin ; j < jMax ; ++ j)
+            if (jMin < jMax)
             {
-                const DataPoint &dp1 = mMainWindow->dataPoint(j);
-                const DataPoint &dp2 = mMainWindow->dataPoint(j + 1);
-
-                dx = m_xValues[Time]->value(dp2, mMainWindow->units())
-                        - m_xValues[Time]->value(dp1, mMainWindow->units());
-                avg = (yValue(i)->value(dp2, mMainWindow->units())
-                        + yValue(i)->value(dp1, mMainWindow->units())) / 2;
-
-                sum += avg * fabs(dx) ;
-                dxSum += fabs(dx);
-
-                min = qMin(min, yValue(i)->value(dp1, mMainWindow->units()));
-                max = qMax(max, yValue(i)->value(dp1, mMainWindow->units()));
+                sum += integral.area[jMax] - integral.area[jMin];
+                dxSum += integral.time[jMax] - integral.time[jMin];
             }
 
-            min = qMin(min, yValue(i)->value(dpMax, mMainWindow->units()));
-            max = qMax(max, yValue(i)->value(dpMax, mMainWindow->units()));
-
             dx = m_xValues[Time]->value(dpHigh, mMainWindow->units())
                     - m_xValues[Time]->value(dpMax, mMainWindow->units());
-            avg = (yValue(i)->value(dpHigh, mMainWindow->units())
-                    + yValue(i)->value(dpMax, mMainWindow->units())) / 2;
+            avg = (yHigh + yValue(i)->value(dpMax, mMainWindow->units())) / 2;
 
             sum += avg * fabs(dx) ;
             dxSum += fabs(dx);
 
-            min = qMin(min, yValue(i)->value(dpHigh, mMainWindow->units()));
-            max = qMax(max, yValue(i)->value(dpHigh, mMainWindow->units()));
+            double min = qMin(yLow, yHigh);
+            double max = qMax(yLow, yHigh);
+
+            double yMin, yMax;
+            if (pyramid.sampleBounds(first, jMax, yMin, yMax))
+            {
+                min = qMin(min, yMin);
+                max = qMax(max, yMax);
+            }
 
             change = yValue(i)->value(dpEnd, mMainWindow->units())
                     - yValue(i)->value(dpStart, mMainWindow->units());
@@ -410,14 +428,15 @@ void DataPlot::setMark(
     if (mMainWindow->dataSize() == 0) return;
 
     DataPoint dp = interpolateDataX(mark);
+    const QDateTime dt = QDateTime::fromMSecsSinceEpoch(dp.timestamp, Qt::UTC);
 
     QString status;
     status = QString("<table width='300'>");
 
     status += QString("<tr style='color:black;'><td align='center'><u>%1 %2.%3 UTC</u></td></tr>")
-            .arg(dp.dateTime.toUTC().date().toString(Qt::ISODate))
-            .arg(dp.dateTime.toUTC().time().toString(Qt::ISODate))
-            .arg(QString("%1").arg(dp.dateTime.time().msec(), 3, 10, QChar('0')));
+            .arg(dt.date().toString(Qt::ISODate))
+            .arg(dt.time().toString(Qt::ISODate))
+            .arg(QString("%1").arg(dt.time().msec(), 3, 10, QChar('0')));
 
     status += QString("<tr style='color:black;'><td align='center'><u>(%1 deg, %2 deg, %3 m)</u></td></tr>")
             .arg(dp.lat, 0, 'f', 7)
@@ -468,6 +487,46 @@ void DataPlot::setRange(
     mMainWindow->setRange(dpLower.t, dpUpper.t);
 }
 
+void DataPlot::updateTrackGraphs()
+{
+    // About two points per pixel column, keeping the extremes of each
+    const QCPRange &range = xAxis->range();
+    const int buckets = qMax(width(), 1);
+
+    QVector< double > keys, values;
+    for (int i = 0; i < mTrackGraphs.size(); ++i)
+    {
+        mTrackPyramids[i].extract(range.lower, range.upper, buckets, keys, values);
+        mTrackGraphs[i]->setData(keys, values, mTrackPyramids[i].sorted());
+    }
+}
+
+void DataPlot::updateOptimalGraphs()
+{
+    int k = 0;
+    for (int j = 0; j < yaLast; ++j)
+    {
+        if (!yValue(j)->visible()) continue;
+
+        QCPGraph *graph = mOptimalGraphs[k];
+        MinMaxPyramid &pyramid = mOptimalPyramids[k];
+        ++k;
+
+        if (!graph) continue;
+
+        QVector< double > xOptimal, yOptimal;
+        for (int i = 0; i < mMainWindow->optimalSize(); ++i)
+        {
+            const DataPoint &dp = mMainWindow->optimalPoint(i);
+            xOptimal.append(xValue()->value(dp, mMainWindow->units()));
+            yOptimal.append(yValue(j)->value(dp, mMainWindow->units()));
+        }
+
+        graph->setData(xOptimal, yOptimal);
+        pyramid.build(xOptimal, yOptimal);
+    }
+}
+
 void DataPlot::updateYRanges()
 {
     const QCPRange &range = xAxis->range();
@@ -478,57 +537,30 @@ void DataPlot::updateYRanges()
         if (!yValue(j)->visible()) continue;
 
         double yMin, yMax;
-        bool first = true;
+        bool found = mTrackPyramids[k].bounds(range.lower, range.upper, yMin, yMax);
 
-        for (int i = 0; i < mMainWindow->dataSize(); ++i)
+        double yMinOptimal, yMaxOptimal;
+        if (mOptimalPyramids[k].bounds(range.lower, range.upper, yMinOptimal, yMaxOptimal))
         {
-            const DataPoint &dp = mMainWindow->dataPoint(i);
-
-            if (range.contains(xValue()->value(dp, mMainWindow->units())))
+            if (found)
             {
-                double y = yValue(j)->value(dp, mMainWindow->units());
-
-                if (first)
-                {
-                    yMin = yMax = y;
-                    first = false;
-                }
-                else
-                {
-                    if (y < yMin) yMin = y;
-                    if (y > yMax) yMax = y;
-                }
+                yMin = qMin(yMin, yMinOptimal);
+                yMax = qMax(yMax, yMaxOptimal);
             }
-        }
-
-        if (yValue(j)->hasOptimal())
-        {
-            for (int i = 0; i < mMainWindow->optimalSize(); ++i)
+            else
             {
-                const DataPoint &dp = mMainWindow->optimalPoint(i);
-
-                if (range.contains(xValue()->value(dp, mMainWindow->units())))
-                {
-                    double y = yValue(j)->value(dp, mMainWindow->units());
-
-                    if (first)
-                    {
-                        yMin = yMax = y;
-                        first = false;
-                    }
-                    else
-                    {
-                        if (y < yMin) yMin = y;
-                        if (y > yMax) yMax = y;
-                    }
-                }
+                yMin = yMinOptimal;
+                yMax = yMaxOptimal;
+                found = true;
             }
         }
 
-        if (!first)
+        ++k;
+
+        if (found)
         {
             const double factor = yValue(j)->factor(mMainWindow->units());
-            axisRect()->axis(QCPAxis::atLeft, k++)->setRange(
+            yValue(j)->axis()->setRange(
                         yValue(j)->useMinimum() ? yValue(j)->minimum() * factor : yMin,
                         yValue(j)->useMaximum() ? yValue(j)->maximum() * factor : yMax);
         }
@@ -540,6 +572,12 @@ void DataPlot::updatePlot()
     clearPlottables();
     clearItems();
 
+    mTrackGraphs.clear();
+    mTrackPyramids.clear();
+    mOptimalGraphs.clear();
+    mOptimalPyramids.clear();
+    mTrackIntegrals.clear();
+
     xAxis->setLabel(xValue()->title(mMainWindow->units()));
 
     // Remove all axes
@@ -555,6 +593,9 @@ void DataPlot::updatePlot()
         yValue(j)->addAxis(this, mMainWindow->units());
     }
 
+    // Add cursor items for the new axes
+    initCursor();
+
     // Return now if plot empty
     if (mMainWindow->dataSize() == 0) return;
 
@@ -562,50 +603,47 @@ void DataPlot::updatePlot()
     DataPoint dpLower = mMainWindow->interpolateDataT(mMainWindow->rangeLower());
     DataPoint dpUpper = mMainWindow->interpolateDataT(mMainWindow->rangeUpper());
 
-    QVector< double > x;
-    for (int i = 0; i < mMainWindow->dataSize(); ++i)
-    {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
-        x.append(xValue()->value(dp, mMainWindow->units()));
-    }
+    const QVector< double > &x = mMainWindow->plotValues(xValue());
+    const QVector< double > &t = mMainWindow->plotValues(m_xValues[Time]);
 
     // Draw plots
     for (int j = 0; j < yaLast; ++j)
     {
         if (!yValue(j)->visible()) continue;
 
-        QVector< double > y;
-        for (int i = 0; i < mMainWindow->dataSize(); ++i)
-        {
-            const DataPoint &dp = mMainWindow->dataPoint(i);
-            y.append(yValue(j)->value(dp, mMainWindow->units()));
-        }
+        const QVector< double > &y = mMainWindow->plotValues(yValue(j));
 
+        // Data is filled in for the visible range by updateTrackGraphs
         QCPAxis *axis = yValue(j)->axis();
         QCPGraph *graph = addGraph(
                     axisRect()->axis(QCPAxis::atBottom),
                     axis);
-        graph->setData(x, y);
         graph->setPen(QPen(yValue(j)->color(), mMainWindow->lineThickness()));
 
+        MinMaxPyramid pyramid;
+        pyramid.build(x, y);
+
+        mTrackGraphs.append(graph);
+        mTrackPyramids.append(pyramid);
+        mTrackIntegrals.append(integrate(t, y));
+
+        // Optimal data is filled in by updateOptimalGraphs
+        QCPGraph *optimalGraph = 0;
+
         if (yValue(j)->hasOptimal())
         {
-            QVector< double > xOptimal, yOptimal;
-            for (int i = 0; i < mMainWindow->optimalSize(); ++i)
-            {
-                const DataPoint &dp = mMainWindow->optimalPoint(i);
-                xOptimal.append(xValue()->value(dp, mMainWindow->units()));
-                yOptimal.append(yValue(j)->value(dp, mMainWindow->units()));
-            }
-
-            QCPGraph *graph = addGraph(
+            optimalGraph = addGraph(
                         axisRect()->axis(QCPAxis::atBottom),
                         axis);
-            graph->setData(xOptimal, yOptimal);
-            graph->setPen(QPen(QBrush(yValue(j)->color()), mMainWindow->lineThickness(), Qt::DotLine));
+            optimalGraph->setPen(QPen(QBrush(yValue(j)->color()), mMainWindow->lineThickness(), Qt::DotLine));
         }
+
+        mOptimalGraphs.append(optimalGraph);
+        mOptimalPyramids.append(MinMaxPyramid());
     }
 
+    updateOptimalGraphs();
+
     if (mMainWindow->windAdjustment())
     {
         // Add label to indicate wind correction
@@ -625,6 +663,43 @@ void DataPlot::updatePlot()
     updateRange();
 }
 
+DataPlot::Integral DataPlot::integrate(
+        const QVector< double > &t,
+        const QVector< double > &y)
+{
+    Integral result;
+
+    result.area.resize(y.size());
+    result.time.resize(y.size());
+
+    double area = 0, time = 0;
+    for (int i = 0; i < y.size(); ++i)
+    {
+        // Skip steps that touch a gap so it doesn't spoil later sums
+        if (i > 0 && !isnan(y[i - 1]) && !isnan(y[i]))
+        {
+            const double dt = fabs(t[i] - t[i - 1]);
+            area += (y[i - 1] + y[i]) / 2 * dt;
+            time += dt;
+        }
+
+        result.area[i] = area;
+        result.time[i] = time;
+    }
+
+    return result;
+}
+
+void DataPlot::updateOptimal()
+{
+    if (mMainWindow->dataSize() == 0) return;
+
+    updateOptimalGraphs();
+
+    // Rescale and redraw annotations, which may depend on the optimum
+    updateRange();
+}
+
 void DataPlot::updateRange()
 {
     if (mMainWindow->dataSize() == 0) return;
@@ -639,54 +714,99 @@ void DataPlot::updateRange()
     // Set x-axis range
     xAxis->setRange(QCPRange(xMin, xMax));
 
+    // Resample track graphs for the new range
+    updateTrackGraphs();
+
     // Set y-axis ranges
     updateYRanges();
 
     // Draw annotations on plot background
     mMainWindow->prepareDataPlot(this);
 
-    // Update cursors
-    updateCursor();
+    // Move cursors
+    moveCursor();
+
+    // Redraw all layers once control returns to the event loop
+    replot(rpQueuedReplot);
 }
 
-void DataPlot::updateCursor()
+void DataPlot::initCursor()
 {
     setCurrentLayer("overlay");
 
-    foreach (QCPLayerable *l, currentLayer()->children())
+    // Marks
+    mMarkGraphs.clear();
+    for (int j = 0; j < yaLast; ++j)
     {
-        if (qobject_cast<QCPAbstractPlottable*>(l))
-        {
-            removePlottable((QCPAbstractPlottable*) l);
-        }
-        else if (qobject_cast<QCPAbstractItem*>(l))
-        {
-            removeItem((QCPAbstractItem*) l);
-        }
+        if (!yValue(j)->visible()) continue;
+
+        QCPGraph *graph = addGraph(xAxis, yValue(j)->axis());
+
+        graph->setPen(QPen(Qt::black, mMainWindow->lineThickness()));
+        graph->setLineStyle(QCPGraph::lsNone);
+        graph->setScatterStyle(QCPScatterStyle::ssDisc);
+        graph->setVisible(false);
+
+        mMarkGraphs.append(graph);
     }
 
+    // Shading spans the axis rect vertically, so it needs no y-axis
+    mCursorShading = new QCPItemRect(this);
+    mCursorShading->setPen(Qt::NoPen);
+    mCursorShading->setBrush(QColor(181, 217, 42, 64));
+    mCursorShading->topLeft->setTypeY(QCPItemPosition::ptAxisRectRatio);
+    mCursorShading->bottomRight->setTypeY(QCPItemPosition::ptAxisRectRatio);
+    mCursorShading->setVisible(false);
+
+    // Vertical lines at the start of a drag and at the cursor
+    mCursorBegin = new QCPItemLine(this);
+    mCursorLine = new QCPItemLine(this);
+
+    QCPItemLine *lines[] = { mCursorBegin, mCursorLine };
+    for (int i = 0; i < 2; ++i)
+    {
+        QCPItemLine *line = lines[i];
+        line->setPen(QPen(Qt::black));
+        line->start->setTypeY(QCPItemPosition::ptAxisRectRatio);
+        line->end->setTypeY(QCPItemPosition::ptAxisRectRatio);
+        line->setVisible(false);
+    }
+
+    // Horizontal line at the cursor pixel
+    mCursorCrosshair = new QCPItemLine(this);
+    mCursorCrosshair->setPen(QPen(Qt::black));
+    mCursorCrosshair->start->setTypeX(QCPItemPosition::ptAxisRectRatio);
+    mCursorCrosshair->start->setTypeY(QCPItemPosition::ptAbsolute);
+    mCursorCrosshair->end->setTypeX(QCPItemPosition::ptAxisRectRatio);
+    mCursorCrosshair->end->setTypeY(QCPItemPosition::ptAbsolute);
+    mCursorCrosshair->setVisible(false);
+
+    setCurrentLayer("main");
+}
+
+void DataPlot::moveCursor()
+{
+    if (!mCursorLine) return;
+
     if (mMainWindow->markActive())
     {
-        // Draw marks
+        // Move marks
         const DataPoint &dpEnd = mMainWindow->interpolateDataT(mMainWindow->markEnd());
 
         QVector< double > xMark, yMark;
         xMark.append(xValue()->value(dpEnd, mMainWindow->units()));
 
-        for (int j = 0; j < yaLast; ++j)
+        int k = 0;
+        for (int j = 0; j < yaLast && k < mMarkGraphs.size(); ++j)
         {
             if (!yValue(j)->visible()) continue;
 
             yMark.clear();
             yMark.append(yValue(j)->value(dpEnd, mMainWindow->units()));
 
-            QCPAxis *axis = yValue(j)->axis();
-            QCPGraph *graph = addGraph(xAxis, axis);
-
-            graph->setData(xMark, yMark);
-            graph->setPen(QPen(Qt::black, mMainWindow->lineThickness()));
-            graph->setLineStyle(QCPGraph::lsNone);
-            graph->setScatterStyle(QCPScatterStyle::ssDisc);
+            QCPGraph *graph = mMarkGraphs[k++];
+            graph->setData(xMark, yMark, true);
+            graph->setVisible(true);
         }
 
         // Update hover text
@@ -706,57 +826,52 @@ void DataPlot::updateCursor()
     }
     else
     {
+        foreach (QCPGraph *graph, mMarkGraphs)
+        {
+            graph->setVisible(false);
+        }
+
         QToolTip::hideText();
     }
 
     MainWindow::Tool tool = mMainWindow->tool();
-    if (!m_cursorValid)
-    {
-        // Draw nothing
-    }
-    else if (m_dragging && (tool == MainWindow::Zoom || tool == MainWindow::Measure))
-    {
-        // Draw shading
-        QCPItemRect *rect = new QCPItemRect(this);
-
-        rect->setPen(Qt::NoPen);
-        rect->setBrush(QColor(181, 217, 42, 64));
-
-        rect->topLeft->setType(QCPItemPosition::ptPlotCoords);
-        rect->topLeft->setAxes(xAxis, yAxis);
-        rect->topLeft->setCoords(m_tBegin, yAxis->range().upper);
-
-        rect->bottomRight->setType(QCPItemPosition::ptPlotCoords);
-        rect->bottomRight->setAxes(xAxis, yAxis);
-        rect->bottomRight->setCoords(m_tCursor, yAxis->range().lower);
+    const bool shading = m_cursorValid && m_dragging
+            && (tool == MainWindow::Zoom || tool == MainWindow::Measure);
+    const bool crosshairs = m_cursorValid && !shading;
 
-        QCPItemLine *line = new QCPItemLine(this);
-        line->setPen(QPen(Qt::black));
-        line->start->setCoords(m_tBegin, yAxis->range().lower);
-        line->end->setCoords(m_tBegin, yAxis->range().upper);
+    if (shading)
+    {
+        mCursorShading->topLeft->setCoords(m_tBegin, 0);
+        mCursorShading->bottomRight->setCoords(m_tCursor, 1);
 
-        line = new QCPItemLine(this);
-        line->setPen(QPen(Qt::black));
-        line->start->setCoords(m_tCursor, yAxis->range().lower);
-        line->end->setCoords(m_tCursor, yAxis->range().upper);
+        mCursorBegin->start->setCoords(m_tBegin, 0);
+        mCursorBegin->end->setCoords(m_tBegin, 1);
     }
-    else
+
+    if (crosshairs)
     {
-        // Draw crosshairs
-        QCPItemLine *line = new QCPItemLine(this);
-        line->setPen(QPen(Qt::black));
-        line->start->setCoords(xAxis->range().lower, yAxis->pixelToCoord(m_yCursor));
-        line->end->setCoords(xAxis->range().upper, yAxis->pixelToCoord(m_yCursor));
+        mCursorCrosshair->start->setCoords(0, m_yCursor);
+        mCursorCrosshair->end->setCoords(1, m_yCursor);
+    }
 
-        line = new QCPItemLine(this);
-        line->setPen(QPen(Qt::black));
-        line->start->setCoords(m_tCursor, yAxis->range().lower);
-        line->end->setCoords(m_tCursor, yAxis->range().upper);
+    if (m_cursorValid)
+    {
+        mCursorLine->start->setCoords(m_tCursor, 0);
+        mCursorLine->end->setCoords(m_tCursor, 1);
     }
 
-    setCurrentLayer("main");
+    mCursorShading->setVisible(shading);
+    mCursorBegin->setVisible(shading);
+    mCursorCrosshair->setVisible(crosshairs);
+    mCursorLine->setVisible(m_cursorValid);
+}
 
-    replot();
+void DataPlot::updateCursor()
+{
+    moveCursor();
+
+    // Only the overlay changes, so leave the buffered data layers alone
+    layer("overlay")->replot();
 }
 
 DataPoint DataPlot::interpolateDataX(
@@ -775,10 +890,12 @@ DataPoint DataPlot::interpolateDataX(
     }
     else
     {
+        const QVector< double > &values = mMainWindow->plotValues(xValue());
+
         const DataPoint &dp1 = mMainWindow->dataPoint(i1);
         const DataPoint &dp2 = mMainWindow->dataPoint(i2);
-        const double x1 = xValue()->value(dp1, mMainWindow->units());
-        const double x2 = xValue()->value(dp2, mMainWindow->units());
+        const double x1 = values[i1];
+        const double x2 = values[i2];
         return DataPoint::interpolate(dp1, dp2, (x - x1) / (x2 - x1));
     }
 }
@@ -786,37 +903,15 @@ DataPoint DataPlot::interpolateDataX(
 int DataPlot::findIndexBelowX(
         double x)
 {
-    int below = -1;
-    int above = mMainWindow->dataSize();
-
-    while (below + 1 != above)
-    {
-        int mid = (below + above) / 2;
-        const DataPoint &dp = mMainWindow->dataPoint(mid);
-
-        if (xValue()->value(dp, mMainWindow->units()) < x) below = mid;
-        else                                               above = mid;
-    }
-
-    return below;
+    const QVector< double > &values = mMainWindow->plotValues(xValue());
+    return qLowerBound(values.constBegin(), values.constEnd(), x) - values.constBegin() - 1;
 }
 
 int DataPlot::findIndexAboveX(
         double x)
 {
-    int below = -1;
-    int above = mMainWindow->dataSize();
-
-    while (below + 1 != above)
-    {
-        int mid = (below + above) / 2;
-        const DataPoint &dp = mMainWindow->dataPoint(mid);
-
-        if (xValue()->value(dp, mMainWindow->units()) > x) above = mid;
-        else                                               below = mid;
-    }
-
-    return above;
+    const QVector< double > &values = mMainWindow->plotValues(xValue());
+    return qUpperBound(values.constBegin(), values.constEnd(), x) - values.constBegin();
 }
 
 void DataPlot::togglePlot(
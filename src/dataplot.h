@@ -27,6 +27,7 @@
 #include "QCustomPlot/qcustomplot.h"
 
 #include "datapoint.h"
+#include "minmaxpyramid.h"
 #include "plotvalue.h"
 
 class MainWindow;
@@ -89,6 +90,7 @@ protected:
     void mouseMoveEvent(QMouseEvent *event);
 
     void wheelEvent(QWheelEvent *event);
+    void resizeEvent(QResizeEvent *event);
 
     void leaveEvent(QEvent *);
 
@@ -106,7 +108,36 @@ private:
 
     QVector< PlotValue* > m_yValues;
 
+    // Track graphs and their level-of-detail summaries, which also give
+    // the y-range of each visible plot
+    QVector< QCPGraph* >     mTrackGraphs;
+    QVector< MinMaxPyramid > mTrackPyramids;
+    QVector< QCPGraph* >     mOptimalGraphs;
+    QVector< MinMaxPyramid > mOptimalPyramids;
+
+    // Running trapezoid integrals over time of each visible plot, so the
+    // Measure tool can average any selection without a scan
+    typedef struct {
+        QVector< double > area;
+        QVector< double > time;
+    } Integral;
+
+    QVector< Integral >      mTrackIntegrals;
+
+    // Cursor items on the overlay layer, moved rather than rebuilt
+    QVector< QCPGraph* > mMarkGraphs;
+    QCPItemRect         *mCursorShading;
+    QCPItemLine         *mCursorBegin;
+    QCPItemLine         *mCursorLine;
+    QCPItemLine         *mCursorCrosshair;
+
+    void initCursor();
+    void moveCursor();
+
+    void updateTrackGraphs();
+    void updateOptimalGraphs();
     void updateYRanges();
+    static Integral integrate(const QVector< double > &t, const QVector< double > &y);
     void setRange(const QCPRange &range);
 
     void setMark(double start, double end);
@@ -124,6 +155,7 @@ private:
 
 public slots:
     void updatePlot();
+    void updateOptimal();
     void updateRange();
     void updateCursor();
 };
@@ -24,7 +24,7 @@
 #ifndef DATAPOINT_H
 #define DATAPOINT_H
 
-#include <QDateTime>
+#include <QtGlobal>
 
 #include <math.h>
 
@@ -33,7 +33,7 @@
 class DataPoint
 {
 public:
-    QDateTime   dateTime;
+    qint64      timestamp;      // UTC milliseconds since epoch
 
     bool        hasGeodetic;
 
@@ -147,33 +147,29 @@ void DataView::updateView()
 
     bool first = true;
 
-    for (int i = 0; i < mMainWindow->dataSize(); ++i)
-    {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
+    const TrackData &track = mMainWindow->track();
 
-        if (lower <= dp.t && dp.t <= upper)
-        {
-            t.append(dp.t);
+    const double *tt = track.constData(TrackData::T);
+    const double *tx = track.constData(TrackData::X);
+    const double *ty = track.constData(TrackData::Y);
+    const double *tz = track.constData(TrackData::Z);
 
-            double xx, yy, zz;
-            double uu, vv;
+    const double factor = (mMainWindow->units() == PlotValue::Metric) ? 1 : METERS_TO_FEET;
 
-            if (mMainWindow->units() == PlotValue::Metric)
-            {
-                xx = dp.x *  cos(mMainWindow->rotation()) + dp.y * sin(mMainWindow->rotation());
-                yy = dp.x * -sin(mMainWindow->rotation()) + dp.y * cos(mMainWindow->rotation());
-                zz = dp.z;
-                uu = dp.x;
-                vv = dp.y;
-            }
-            else
-            {
-                xx = (dp.x *  cos(mMainWindow->rotation()) + dp.y * sin(mMainWindow->rotation())) * METERS_TO_FEET;
-                yy = (dp.x * -sin(mMainWindow->rotation()) + dp.y * cos(mMainWindow->rotation())) * METERS_TO_FEET;
-                zz = dp.z * METERS_TO_FEET;
-                uu = dp.x * METERS_TO_FEET;
-                vv = dp.y * METERS_TO_FEET;
-            }
+    const double cosRotation = cos(mMainWindow->rotation());
+    const double sinRotation = sin(mMainWindow->rotation());
+
+    for (int i = 0; i < track.size(); ++i)
+    {
+        if (lower <= tt[i] && tt[i] <= upper)
+        {
+            t.append(tt[i]);
+
+            const double xx = (tx[i] *  cosRotation + ty[i] * sinRotation) * factor;
+            const double yy = (tx[i] * -sinRotation + ty[i] * cosRotation) * factor;
+            const double zz = tz[i] * factor;
+            const double uu = tx[i] * factor;
+            const double vv = ty[i] * factor;
 
             x.append(xx);
             y.append(yy);
@@ -0,0 +1,193 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "differentialevolution.h"
+
+#include "randomstream.h"
+
+namespace
+{
+
+const int    populationSize = 40;   // Number of agents
+const double weight         = 0.6;  // Differential weight (F)
+const double crossover      = 0.9;  // Crossover probability (CR)
+
+} // namespace
+
+int DifferentialEvolution::maximum(
+        const Parameters &params) const
+{
+    return (params.kMax - params.kMin + 1) * (params.maxGenerations + 1) * populationSize
+            + polishMaximum(params);
+}
+
+DifferentialEvolution::Points DifferentialEvolution::refine(
+        const Points &points)
+{
+    Points result;
+    result.reserve(2 * points.size() - 1);
+
+    for (int i = 0; i + 1 < points.size(); ++i)
+    {
+        result.append(points[i]);
+        result.append((points[i] + points[i + 1]) / 2);
+    }
+    result.append(points.last());
+
+    return result;
+}
+
+Score DifferentialEvolution::optimize(
+        ScoringMethod *method,
+        const Parameters &params,
+        Context &context)
+{
+    const Parameters &p = params;
+
+    // Random starting points at the coarsest level
+    QVector< Points > agents(populationSize);
+    for (int i = 0; i < populationSize; ++i)
+    {
+        RandomStream random(p.seed, p.kMin, -1, i);
+
+        Points &x = agents[i];
+        for (int d = 0; d <= (1 << p.kMin); ++d)
+        {
+            x.append(p.minLift + random.uniform() * (p.maxLift - p.minLift));
+        }
+    }
+
+    GenePool scores(populationSize);
+    GenePool trials(populationSize);
+
+    int progress = 0;
+    bool running = true;
+
+    // Increasing levels of detail
+    for (int k = p.kMin; k <= p.kMax && running; ++k)
+    {
+        if (k > p.kMin)
+        {
+            for (int i = 0; i < populationSize; ++i)
+            {
+                agents[i] = refine(agents[i]);
+            }
+        }
+
+        // Score the population at this level
+        for (int i = 0; i < populationSize; ++i)
+        {
+            scores[i] = Score(0, expand(agents[i], p.genomeSize));
+        }
+        evaluate(method, p, scores);
+
+        int best = 0;
+        for (int i = 1; i < populationSize; ++i)
+        {
+            if (scores[i].first > scores[best].first) best = i;
+        }
+
+        progress += populationSize;
+        running = context.report(progress, scores[best]);
+
+        const int dim = agents[0].size();
+        QVector< Points > candidates(populationSize);
+
+        Convergence convergence(p);
+
+        // Generations
+        for (int j = 0; running; ++j)
+        {
+            const Points &xBest = agents[best];
+
+            for (int i = 0; i < populationSize; ++i)
+            {
+                // Keyed on position so the run is reproducible
+                RandomStream random(p.seed, k, j, i);
+
+                int r1, r2;
+                do { r1 = random.bounded(populationSize); } while (r1 == i);
+                do { r2 = random.bounded(populationSize); } while (r2 == i || r2 == r1);
+
+                const Points &x = agents[i];
+                const Points &x1 = agents[r1];
+                const Points &x2 = agents[r2];
+
+                Points &y = candidates[i];
+                y = x;
+
+                const int dRand = random.bounded(dim);
+                for (int d = 0; d < dim; ++d)
+                {
+                    if (d == dRand || random.uniform() < crossover)
+                    {
+                        const double v = x[d] + weight * (xBest[d] - x[d]) + weight * (x1[d] - x2[d]);
+                        y[d] = qBound(p.minLift, v, p.maxLift);
+                    }
+                }
+
+                trials[i] = Score(0, expand(y, p.genomeSize));
+            }
+
+            // Trials within a generation are independent
+            evaluate(method, p, trials);
+
+            // Keep each trial that does at least as well as its parent
+            for (int i = 0; i < populationSize; ++i)
+            {
+                if (trials[i].first >= scores[i].first)
+                {
+                    agents[i] = candidates[i];
+                    scores[i] = trials[i];
+                }
+
+                if (scores[i].first > scores[best].first) best = i;
+            }
+
+            progress += populationSize;
+
+            if (convergence.update(scores[best].first))
+            {
+                // Count skipped generations as done
+                progress = (k - p.kMin + 1) * (p.maxGenerations + 1) * populationSize;
+                running = context.report(progress, scores[best]);
+                break;
+            }
+
+            running = context.report(progress, scores[best]);
+        }
+    }
+
+    int best = 0;
+    for (int i = 1; i < populationSize; ++i)
+    {
+        if (scores[i].first > scores[best].first) best = i;
+    }
+
+    // Finish with a local search from the best agent
+    Score result = scores[best];
+    if (running) polish(method, p, result, progress, context);
+
+    return result;
+}
@@ -0,0 +1,46 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef DIFFERENTIALEVOLUTION_H
+#define DIFFERENTIALEVOLUTION_H
+
+#include <QVector>
+
+#include "optimizer.h"
+
+// Differential evolution (DE/current-to-best/1/bin) over the control
+// points of the current level of detail. Moving to a finer level inserts
+// midpoints, which leaves every genome unchanged.
+class DifferentialEvolution : public Optimizer
+{
+public:
+    int maximum(const Parameters &params) const;
+    Score optimize(ScoringMethod *method, const Parameters &params,
+                   Context &context);
+
+private:
+    static Points refine(const Points &points);
+};
+
+#endif // DIFFERENTIALEVOLUTION_H
@@ -46,6 +46,13 @@ FlareForm::FlareForm(QWidget *parent) :
     connect(ui->actualButton, SIGNAL(clicked()), this, SLOT(onActualButtonClicked()));
     connect(ui->optimalButton, SIGNAL(clicked()), this, SLOT(onOptimalButtonClicked()));
     connect(ui->optimizeButton, SIGNAL(clicked()), this, SLOT(onOptimizeButtonClicked()));
+    connect(ui->optimizeAllButton, SIGNAL(clicked()), this, SLOT(onOptimizeAllButtonClicked()));
+
+    // Optimization engines in MainWindow::OptimizationEngine order
+    ui->engineComboBox->addItem(tr("Genetic algorithm"));
+    ui->engineComboBox->addItem(tr("Differential evolution"));
+    connect(ui->engineComboBox, SIGNAL(activated(int)), this, SLOT(onEngineChanged(int)));
+    connect(ui->toleranceEdit, SIGNAL(editingFinished()), this, SLOT(onToleranceChanged()));
 }
 
 FlareForm::~FlareForm()
@@ -63,6 +70,10 @@ void FlareForm::setMainWindow(
         MainWindow *mainWindow)
 {
     mMainWindow = mainWindow;
+
+    // The engine is shared by all forms, so follow changes made elsewhere
+    connect(mMainWindow, SIGNAL(optimizationEngineChanged()),
+            this, SLOT(updateEngine()));
 }
 
 void FlareForm::updateView()
@@ -70,6 +81,9 @@ void FlareForm::updateView()
     // Update mode selection
     ui->actualButton->setChecked(mMainWindow->windowMode() == MainWindow::Actual);
     ui->optimalButton->setChecked(mMainWindow->windowMode() == MainWindow::Optimal);
+    updateEngine();
+    ui->toleranceEdit->setText(QString("%1").arg(
+                                   mMainWindow->scoringMethod(MainWindow::Flare)->integrationTolerance()));
 
     FlareScoring *method = (FlareScoring *) mMainWindow->scoringMethod(MainWindow::Flare);
 
@@ -168,3 +182,34 @@ void FlareForm::onOptimizeButtonClicked()
     // Switch to optimal view
     mMainWindow->setWindowMode(MainWindow::Optimal);
 }
+
+void FlareForm::onOptimizeAllButtonClicked()
+{
+    FlareScoring *method = (FlareScoring *) mMainWindow->scoringMethod(MainWindow::Flare);
+    method->optimizeAll();
+}
+
+void FlareForm::updateEngine()
+{
+    ui->engineComboBox->setCurrentIndex(mMainWindow->optimizationEngine());
+}
+
+void FlareForm::onEngineChanged(
+        int index)
+{
+    mMainWindow->setOptimizationEngine((MainWindow::OptimizationEngine) index);
+}
+
+void FlareForm::onToleranceChanged()
+{
+    // Zero selects fixed RK4 steps
+    double tolerance = ui->toleranceEdit->text().toDouble();
+    if (tolerance < 0) tolerance = 0;
+
+    FlareScoring *method = (FlareScoring *) mMainWindow->scoringMethod(MainWindow::Flare);
+    method->setIntegrationTolerance(tolerance);
+
+    ui->toleranceEdit->setText(QString("%1").arg(tolerance));
+
+    mMainWindow->setFocus();
+}
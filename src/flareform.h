@@ -53,6 +53,7 @@ private:
 
 public slots:
     void updateView();
+    void updateEngine();
 
 private slots:
     void onApplyButtonClicked();
@@ -60,6 +61,9 @@ private slots:
     void onActualButtonClicked();
     void onOptimalButtonClicked();
     void onOptimizeButtonClicked();
+    void onOptimizeAllButtonClicked();
+    void onEngineChanged(int index);
+    void onToleranceChanged();
 };
 
 
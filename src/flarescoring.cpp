@@ -23,6 +23,8 @@
 
 #include "flarescoring.h"
 
+#include <QSettings>
+
 #include "mainwindow.h"
 
 FlareScoring::FlareScoring(
@@ -183,3 +185,21 @@ bool FlareScoring::getWindowBounds(
 
     return (result.size() > 0) && (dpTop.hMSL > dpBottom.hMSL);
 }
+
+void FlareScoring::readSettings()
+{
+    QSettings settings("FlySight", "Viewer");
+
+    settings.beginGroup("flareScoring");
+        readIntegrationTolerance(settings);
+    settings.endGroup();
+}
+
+void FlareScoring::writeSettings()
+{
+    QSettings settings("FlySight", "Viewer");
+
+    settings.beginGroup("flareScoring");
+        writeIntegrationTolerance(settings);
+    settings.endGroup();
+}
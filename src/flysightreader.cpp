@@ -0,0 +1,370 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "flysightreader.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+#include <string.h>
+
+namespace
+{
+
+// Exact powers of ten (all representable as doubles)
+const double POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Largest integer below which every integer is exact in a double
+const quint64 MAX_EXACT = Q_UINT64_C(9007199254740992);
+
+bool readDigits(
+        const char *&p,
+        const char *end,
+        int count,
+        int &value)
+{
+    value = 0;
+    for (int i = 0; i < count; ++i, ++p)
+    {
+        if (p == end || *p < '0' || *p > '9') return false;
+        value = value * 10 + (*p - '0');
+    }
+    return true;
+}
+
+bool expect(
+        const char *&p,
+        const char *end,
+        char c)
+{
+    if (p == end || *p != c) return false;
+    ++p;
+    return true;
+}
+
+qint64 daysFromCivil(
+        int y,
+        int m,
+        int d)
+{
+    // See http://howardhinnant.github.io/date_algorithms.html
+    y -= (m <= 2);
+    const qint64 era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+int daysInMonth(
+        int y,
+        int m)
+{
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (m == 2 && (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0))) return 29;
+    return days[m - 1];
+}
+
+} // namespace
+
+FlySightReader::FlySightReader(
+        const char *data,
+        qint64 size):
+    mPos(data),
+    mEnd(data + size)
+{
+    for (int i = 0; i < colLast; ++i)
+    {
+        mColumn[i] = -1;
+    }
+}
+
+bool FlySightReader::read(
+        MainWindow::DataPoints &data)
+{
+    const char *begin, *end;
+
+    data.clear();
+
+    // Read column labels
+    if (!nextLine(begin, end)) return false;
+    readHeader(begin, end);
+
+    // Skip units row
+    if (!nextLine(begin, end)) return true;
+
+    // Guess row count from the first data row
+    const char *rowBegin = mPos;
+    if (nextLine(begin, end))
+    {
+        const qint64 rowSize = mPos - rowBegin;
+        if (rowSize > 0)
+        {
+            data.reserve((mEnd - rowBegin) / rowSize + 1);
+        }
+
+        do
+        {
+            // Skip blank lines
+            if (begin == end) continue;
+
+            DataPoint pt;
+            readRow(begin, end, pt);
+            data.append(pt);
+        }
+        while (nextLine(begin, end));
+    }
+
+    return true;
+}
+
+bool FlySightReader::nextLine(
+        const char *&begin,
+        const char *&end)
+{
+    if (mPos >= mEnd) return false;
+
+    begin = mPos;
+
+    const char *p = (const char *) memchr(mPos, '\n', mEnd - mPos);
+    if (p)
+    {
+        end = p;
+        mPos = p + 1;
+    }
+    else
+    {
+        end = mPos = mEnd;
+    }
+
+    // Strip carriage return
+    if (end > begin && end[-1] == '\r') --end;
+
+    return true;
+}
+
+void FlySightReader::readHeader(
+        const char *begin,
+        const char *end)
+{
+    int i = 0;
+    while (begin <= end)
+    {
+        const char *p = (const char *) memchr(begin, ',', end - begin);
+        if (!p) p = end;
+
+        const QByteArray s = QByteArray::fromRawData(begin, p - begin);
+
+        if (s == "time")    mColumn[Time]    = i;
+        if (s == "lat")     mColumn[Lat]     = i;
+        if (s == "lon")     mColumn[Lon]     = i;
+        if (s == "hMSL")    mColumn[HMSL]    = i;
+        if (s == "velN")    mColumn[VelN]    = i;
+        if (s == "velE")    mColumn[VelE]    = i;
+        if (s == "velD")    mColumn[VelD]    = i;
+        if (s == "hAcc")    mColumn[HAcc]    = i;
+        if (s == "vAcc")    mColumn[VAcc]    = i;
+        if (s == "sAcc")    mColumn[SAcc]    = i;
+        if (s == "numSV")   mColumn[NumSV]   = i;
+
+        begin = p + 1;
+        ++i;
+    }
+}
+
+void FlySightReader::readRow(
+        const char *begin,
+        const char *end,
+        DataPoint &pt)
+{
+    // Split row into fields
+    const int maxFields = 32;
+    const char *fieldBegin[maxFields];
+    const char *fieldEnd[maxFields];
+
+    int n = 0;
+    while (begin <= end && n < maxFields)
+    {
+        const char *p = (const char *) memchr(begin, ',', end - begin);
+        if (!p) p = end;
+
+        fieldBegin[n] = begin;
+        fieldEnd[n] = p;
+        ++n;
+
+        begin = p + 1;
+    }
+
+    double value[colLast];
+    for (int i = Lat; i < colLast; ++i)
+    {
+        const int j = mColumn[i];
+        value[i] = (0 <= j && j < n) ? parseNumber(fieldBegin[j], fieldEnd[j]) : 0;
+    }
+
+    const int j = mColumn[Time];
+    if (0 <= j && j < n)
+    {
+        qint64 msecs;
+        if (parseDateTime(fieldBegin[j], fieldEnd[j], msecs))
+        {
+            pt.timestamp = msecs;
+        }
+        else
+        {
+            pt.timestamp = QDateTime::fromString(
+                        QString::fromLatin1(fieldBegin[j], fieldEnd[j] - fieldBegin[j]),
+                        Qt::ISODate).toMSecsSinceEpoch();
+        }
+    }
+
+    pt.hasGeodetic = true;
+
+    pt.lat   = value[Lat];
+    pt.lon   = value[Lon];
+    pt.hMSL  = value[HMSL];
+
+    pt.velN  = value[VelN];
+    pt.velE  = value[VelE];
+    pt.velD  = value[VelD];
+
+    pt.hAcc  = value[HAcc];
+    pt.vAcc  = value[VAcc];
+    pt.sAcc  = value[SAcc];
+
+    pt.numSV = value[NumSV];
+}
+
+bool FlySightReader::parseDateTime(
+        const char *begin,
+        const char *end,
+        qint64 &msecs)
+{
+    // Handles the UTC form written by FlySight, e.g.
+    //   2018-05-12T14:23:45.20Z
+    // Anything else is left to QDateTime.
+    const char *p = begin;
+    int year, month, day, hour, minute, second;
+
+    if (!readDigits(p, end, 4, year))   return false;
+    if (!expect(p, end, '-'))           return false;
+    if (!readDigits(p, end, 2, month))  return false;
+    if (!expect(p, end, '-'))           return false;
+    if (!readDigits(p, end, 2, day))    return false;
+    if (!expect(p, end, 'T'))           return false;
+    if (!readDigits(p, end, 2, hour))   return false;
+    if (!expect(p, end, ':'))           return false;
+    if (!readDigits(p, end, 2, minute)) return false;
+    if (!expect(p, end, ':'))           return false;
+    if (!readDigits(p, end, 2, second)) return false;
+
+    if (month < 1 || month > 12)                 return false;
+    if (day < 1 || day > daysInMonth(year, month)) return false;
+    if (hour > 23 || minute > 59 || second > 59) return false;
+
+    // Fractional seconds are rounded to milliseconds the same way
+    // QDateTime::fromString does (at most four digits are used)
+    int msec = 0;
+    if (p != end && (*p == '.' || *p == ','))
+    {
+        ++p;
+
+        int fraction = 0, digits = 0;
+        while (p != end && '0' <= *p && *p <= '9' && digits < 4)
+        {
+            fraction = fraction * 10 + (*p - '0');
+            ++digits;
+            ++p;
+        }
+        if (digits == 0) return false;
+
+        const int scale = (int) POW10[digits];
+        msec = qMin((fraction * 2000 + scale) / (2 * scale), 999);
+    }
+
+    if (!expect(p, end, 'Z')) return false;
+    if (p != end)             return false;
+
+    const qint64 days = daysFromCivil(year, month, day);
+    msecs = ((days * 24 + hour) * 60 + minute) * 60 + second;
+    msecs = msecs * 1000 + msec;
+
+    return true;
+}
+
+double FlySightReader::parseNumber(
+        const char *begin,
+        const char *end)
+{
+    // Fast path for plain decimals whose digits fit exactly in a double.
+    // Dividing two exact values gives a correctly rounded result, so this
+    // matches QString::toDouble bit for bit. Anything else falls back to
+    // the library conversion.
+    const char *p = begin;
+
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    quint64 mantissa = 0;
+    int digits = 0, fractionDigits = 0;
+    bool fraction = false;
+
+    for (; p != end; ++p)
+    {
+        const char c = *p;
+        if ('0' <= c && c <= '9')
+        {
+            if (++digits > 19) break;
+            mantissa = mantissa * 10 + (c - '0');
+            if (fraction) ++fractionDigits;
+        }
+        else if (c == '.' && !fraction)
+        {
+            fraction = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (p == end && digits > 0 && mantissa <= MAX_EXACT && fractionDigits <= 22)
+    {
+        const double value = (double) mantissa / POW10[fractionDigits];
+        return negative ? -value : value;
+    }
+
+    if (begin == end) return 0;
+
+    return QByteArray::fromRawData(begin, end - begin).toDouble();
+}
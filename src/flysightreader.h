@@ -0,0 +1,71 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef FLYSIGHTREADER_H
+#define FLYSIGHTREADER_H
+
+#include <QVector>
+
+#include "datapoint.h"
+#include "mainwindow.h"
+
+class FlySightReader
+{
+public:
+    FlySightReader(const char *data, qint64 size);
+
+    bool read(MainWindow::DataPoints &data);
+
+    static bool parseDateTime(const char *begin, const char *end,
+                              qint64 &msecs);
+    static double parseNumber(const char *begin, const char *end);
+
+private:
+    // Column enumeration
+    typedef enum {
+        Time = 0,
+        Lat,
+        Lon,
+        HMSL,
+        VelN,
+        VelE,
+        VelD,
+        HAcc,
+        VAcc,
+        SAcc,
+        NumSV,
+        colLast
+    } Columns;
+
+    const char *mPos;
+    const char *mEnd;
+
+    int         mColumn[colLast];
+
+    bool nextLine(const char *&begin, const char *&end);
+    void readHeader(const char *begin, const char *end);
+    void readRow(const char *begin, const char *end, DataPoint &pt);
+};
+
+#endif // FLYSIGHTREADER_H
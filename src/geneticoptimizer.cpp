@@ -0,0 +1,173 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "geneticoptimizer.h"
+
+#include "randomstream.h"
+
+namespace
+{
+
+const int workingSize    = 100;     // Working population
+const int keepSize       = 10;      // Number of elites to keep
+const int newSize        = 10;      // New genomes in first level
+const int tournamentSize = 5;       // Number of individuals in a tournament
+const int mutationRate   = 100;     // Frequency of mutations
+const int truncationRate = 10;      // Frequency of truncations
+
+const Genome &selectGenome(
+        const GenePool &genePool,
+        const int tournamentSize,
+        RandomStream &random)
+{
+    int jMax;
+    double sMax;
+    bool first = true;
+
+    for (int i = 0; i < tournamentSize; ++i)
+    {
+        const int j = random.bounded(genePool.size());
+        if (first || genePool[j].first > sMax)
+        {
+            jMax = j;
+            sMax = genePool[j].first;
+            first = false;
+        }
+    }
+
+    return genePool[jMax].second;
+}
+
+} // namespace
+
+int GeneticOptimizer::maximum(
+        const Parameters &params) const
+{
+    return (params.kMax - params.kMin + 1) * params.maxGenerations * workingSize + workingSize
+            + polishMaximum(params);
+}
+
+Genome GeneticOptimizer::create(
+        const Parameters &params,
+        const GenePool &parents,
+        int level,
+        int generation,
+        int index,
+        bool isNew) const
+{
+    // Each individual draws from its own random stream keyed on its
+    // position, so a given seed always produces the same population
+    RandomStream random(params.seed, level, generation, index);
+
+    if (isNew)
+    {
+        return Genome(params.genomeSize, params.kMin, params.minLift, params.maxLift, random);
+    }
+
+    const Genome &p1 = selectGenome(parents, tournamentSize, random);
+    const Genome &p2 = selectGenome(parents, tournamentSize, random);
+    Genome g(p1, p2, level, random);
+
+    if (random.bounded(100) < truncationRate)
+    {
+        g.truncate(level);
+    }
+    if (random.bounded(100) < mutationRate)
+    {
+        g.mutate(level, params.kMin, params.minLift, params.maxLift, random);
+    }
+
+    return g;
+}
+
+Score GeneticOptimizer::optimize(
+        ScoringMethod *method,
+        const Parameters &params,
+        Context &context)
+{
+    const Parameters &p = params;
+
+    GenePool genePool;
+
+    // Add new individuals
+    for (int i = 0; i < workingSize; ++i)
+    {
+        genePool.append(Score(0, create(p, genePool, p.kMin, -1, i, true)));
+    }
+
+    evaluate(method, p, genePool);
+
+    // Sort gene pool by score
+    qSort(genePool);
+
+    int progress = workingSize;
+    bool running = context.report(progress, genePool[0]);
+
+    // Increasing levels of detail
+    for (int k = p.kMin; k <= p.kMax && running; ++k)
+    {
+        Convergence convergence(p);
+
+        // Generations
+        for (int j = 0; running; ++j)
+        {
+            // Elitism
+            GenePool newGenePool = genePool.mid(0, keepSize);
+
+            // New individuals in first level, then offspring
+            for (int i = keepSize; i < workingSize; ++i)
+            {
+                const bool isNew = (k == p.kMin && i < keepSize + newSize);
+                newGenePool.append(Score(0, create(p, genePool, k, j, i, isNew)));
+            }
+
+            // Individuals within a generation are independent
+            evaluate(method, p, newGenePool, keepSize);
+
+            genePool = newGenePool;
+
+            // Sort gene pool by score
+            qSort(genePool);
+
+            progress += workingSize;
+
+            if (convergence.update(genePool[0].first))
+            {
+                // Count skipped generations as done
+                const int level = k - p.kMin + 1;
+                progress = level * p.maxGenerations * workingSize + workingSize;
+                running = context.report(progress, genePool[0]);
+                break;
+            }
+
+            running = context.report(progress, genePool[0]);
+        }
+    }
+
+    // Finish with a local search from the most fit individual
+    Score best = genePool[0];
+    if (running) polish(method, p, best, progress, context);
+
+    return best;
+}
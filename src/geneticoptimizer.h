@@ -0,0 +1,45 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef GENETICOPTIMIZER_H
+#define GENETICOPTIMIZER_H
+
+#include "optimizer.h"
+
+// Tournament-selection genetic algorithm. Offspring are formed by
+// crossover at a control point, then truncated and mutated at the current
+// level of detail.
+class GeneticOptimizer : public Optimizer
+{
+public:
+    int maximum(const Parameters &params) const;
+    Score optimize(ScoringMethod *method, const Parameters &params,
+                   Context &context);
+
+private:
+    Genome create(const Parameters &params, const GenePool &parents,
+                  int level, int generation, int index, bool isNew) const;
+};
+
+#endif // GENETICOPTIMIZER_H
@@ -21,7 +21,9 @@
 **  Website: http://flysight.ca/                                          **
 ****************************************************************************/
 
+#include "atmosphere.h"
 #include "genome.h"
+#include "randomstream.h"
 
 Genome::Genome()
 {
@@ -37,12 +39,13 @@ Genome::Genome(
 Genome::Genome(
         const Genome &p1,
         const Genome &p2,
-        int k)
+        int k,
+        RandomStream &random)
 {
     const int parts = 1 << k;
     const int partSize = (p1.size() - 1) / parts;
 
-    const int pivot = qrand() % parts;
+    const int pivot = random.bounded(parts);
 
     const int j1 = pivot * partSize;
     const int j2 = (pivot + 1) * partSize;
@@ -62,15 +65,16 @@ Genome::Genome(
         int genomeSize,
         int k,
         double minLift,
-        double maxLift)
+        double maxLift,
+        RandomStream &random)
 {
     const int parts = 1 << k;
     const int partSize = (genomeSize - 1) / parts;
 
-    double prevLift = minLift + (double) qrand() / RAND_MAX * (maxLift - minLift);
+    double prevLift = minLift + random.uniform() * (maxLift - minLift);
     for (int i = 0; i < parts; ++i)
     {
-        double nextLift = minLift + (double) qrand() / RAND_MAX * (maxLift - minLift);
+        double nextLift = minLift + random.uniform() * (maxLift - minLift);
         for (int j = 0; j < partSize; ++j)
         {
             append(prevLift + (double) j / partSize * (nextLift - prevLift));
@@ -84,18 +88,19 @@ void Genome::mutate(
         int k,
         int kMin,
         double minLift,
-        double maxLift)
+        double maxLift,
+        RandomStream &random)
 {
     const int parts = 1 << k;
     const int partSize = (size() - 1) / parts;
 
-    const int i = qrand() % (parts + 1);
+    const int i = random.bounded(parts + 1);
     const double cl = at(i * partSize);
 
     const double range = maxLift / (1 << (k - kMin));
     const double minr = qMax(minLift - cl, -range);
     const double maxr = qMin(maxLift - cl,  range);
-    const double r = minr + (double) qrand() / RAND_MAX * (maxr - minr);
+    const double r = minr + random.uniform() * (maxr - minr);
 
     if (i > 0)
     {
@@ -145,7 +150,22 @@ MainWindow::DataPoints Genome::simulate(
         double planformArea,
         double mass,
         const DataPoint &dp0,
-        double windowBottom)
+        double windowBottom) const
+{
+    MainWindow::DataPoints result;
+    simulate(h, a, c, planformArea, mass, dp0, windowBottom, result);
+    return result;
+}
+
+void Genome::simulate(
+        double h,
+        double a,
+        double c,
+        double planformArea,
+        double mass,
+        const DataPoint &dp0,
+        double windowBottom,
+        MainWindow::DataPoints &result) const
 {
     const double velH = sqrt(dp0.vx * dp0.vx + dp0.vy * dp0.vy);
 
@@ -157,9 +177,18 @@ MainWindow::DataPoints Genome::simulate(
     double dist2D = dp0.dist2D;
     double dist3D = dp0.dist3D;
 
-    MainWindow::DataPoints result(1, dp0);
+    // Size for the longest possible trajectory up front. Reserving marks
+    // the capacity as fixed, so shrinking at the end keeps the allocation
+    // and a buffer passed in again is reused as is.
+    result.reserve(qMax(size(), 1));
+    result.resize(qMax(size(), 1));
 
-    for (int i = 0; i < size(); ++i)
+    DataPoint *out = result.data();
+    *out++ = dp0;
+
+    const Atmosphere &atmosphere = Atmosphere::standard();
+
+    for (int i = 0; i + 1 < size(); ++i)
     {
         const double lift_prev = lift(at(i));
         const double drag_prev = drag(at(i), a, c);
@@ -169,23 +198,27 @@ MainWindow::DataPoints Genome::simulate(
 
         // Runge-Kutta integration
         // See https://en.wikipedia.org/wiki/Runge%E2%80%93Kutta_methods
-        const double k0 = h * dtheta_dt(theta, v, x, y, lift_prev, planformArea, mass);
-        const double l0 = h *     dv_dt(theta, v, x, y, drag_prev, planformArea, mass);
+        const double rho0 = atmosphere.density(y);
+        const double k0 = h * dtheta_dt(theta, v, rho0, lift_prev, planformArea, mass);
+        const double l0 = h *     dv_dt(theta, v, rho0, drag_prev, planformArea, mass);
         const double m0 = h *     dx_dt(theta, v, x, y);
         const double n0 = h *     dy_dt(theta, v, x, y);
 
-        const double k1 = h * dtheta_dt(theta + k0/2, v + l0/2, x + m0/2, y + n0/2, (lift_prev + lift_next) / 2, planformArea, mass);
-        const double l1 = h *     dv_dt(theta + k0/2, v + l0/2, x + m0/2, y + n0/2, (drag_prev + drag_next) / 2, planformArea, mass);
+        const double rho1 = atmosphere.density(y + n0/2);
+        const double k1 = h * dtheta_dt(theta + k0/2, v + l0/2, rho1, (lift_prev + lift_next) / 2, planformArea, mass);
+        const double l1 = h *     dv_dt(theta + k0/2, v + l0/2, rho1, (drag_prev + drag_next) / 2, planformArea, mass);
         const double m1 = h *     dx_dt(theta + k0/2, v + l0/2, x + m0/2, y + n0/2);
         const double n1 = h *     dy_dt(theta + k0/2, v + l0/2, x + m0/2, y + n0/2);
 
-        const double k2 = h * dtheta_dt(theta + k1/2, v + l1/2, x + m1/2, y + n1/2, (lift_prev + lift_next) / 2, planformArea, mass);
-        const double l2 = h *     dv_dt(theta + k1/2, v + l1/2, x + m1/2, y + n1/2, (drag_prev + drag_next) / 2, planformArea, mass);
+        const double rho2 = atmosphere.density(y + n1/2);
+        const double k2 = h * dtheta_dt(theta + k1/2, v + l1/2, rho2, (lift_prev + lift_next) / 2, planformArea, mass);
+        const double l2 = h *     dv_dt(theta + k1/2, v + l1/2, rho2, (drag_prev + drag_next) / 2, planformArea, mass);
         const double m2 = h *     dx_dt(theta + k1/2, v + l1/2, x + m1/2, y + n1/2);
         const double n2 = h *     dy_dt(theta + k1/2, v + l1/2, x + m1/2, y + n1/2);
 
-        const double k3 = h * dtheta_dt(theta + k2, v + l2, x + m2, y + n2, lift_next, planformArea, mass);
-        const double l3 = h *     dv_dt(theta + k2, v + l2, x + m2, y + n2, drag_next, planformArea, mass);
+        const double rho3 = atmosphere.density(y + n2);
+        const double k3 = h * dtheta_dt(theta + k2, v + l2, rho3, lift_next, planformArea, mass);
+        const double l3 = h *     dv_dt(theta + k2, v + l2, rho3, drag_next, planformArea, mass);
         const double m3 = h *     dx_dt(theta + k2, v + l2, x + m2, y + n2);
         const double n3 = h *     dy_dt(theta + k2, v + l2, x + m2, y + n2);
 
@@ -201,7 +234,7 @@ MainWindow::DataPoints Genome::simulate(
         y     += dy;
 
         // Add data point
-        DataPoint pt;
+        DataPoint &pt = *out++;
 
         pt.hasGeodetic = false;
 
@@ -228,32 +261,234 @@ MainWindow::DataPoints Genome::simulate(
         pt.lift = lift_next;
         pt.drag = drag_next;
 
-        result.append(pt);
-
         if (pt.z < windowBottom) break;
     }
 
-    return result;
+    result.resize(out - result.constData());
+}
+
+void Genome::simulateAdaptive(
+        double h,
+        double a,
+        double c,
+        double planformArea,
+        double mass,
+        const DataPoint &dp0,
+        double windowBottom,
+        double tolerance,
+        MainWindow::DataPoints &result) const
+{
+    // Dormand-Prince 5(4) coefficients
+    // See https://en.wikipedia.org/wiki/Dormand%E2%80%93Prince_method
+    static const double a21 = 1.0 / 5;
+    static const double a31 = 3.0 / 40,        a32 = 9.0 / 40;
+    static const double a41 = 44.0 / 45,       a42 = -56.0 / 15,      a43 = 32.0 / 9;
+    static const double a51 = 19372.0 / 6561,  a52 = -25360.0 / 2187, a53 = 64448.0 / 6561,
+                        a54 = -212.0 / 729;
+    static const double a61 = 9017.0 / 3168,   a62 = -355.0 / 33,     a63 = 46732.0 / 5247,
+                        a64 = 49.0 / 176,      a65 = -5103.0 / 18656;
+    static const double a71 = 35.0 / 384,      a73 = 500.0 / 1113,    a74 = 125.0 / 192,
+                        a75 = -2187.0 / 6784,  a76 = 11.0 / 84;
+
+    // Difference between fifth- and fourth-order weights
+    static const double e1 = 71.0 / 57600,     e3 = -71.0 / 16695,    e4 = 71.0 / 1920,
+                        e5 = -17253.0 / 339200, e6 = 22.0 / 525,      e7 = -1.0 / 40;
+
+    // Continuous extension, from Hairer, Norsett & Wanner
+    static const double d1 = -12715105075.0 / 11282082432, d3 = 87487479700.0 / 32700410799,
+                        d4 = -10690763975.0 / 1880347072,  d5 = 701980252875.0 / 199316789632,
+                        d6 = -1453857185.0 / 822651844,    d7 = 69997945.0 / 29380423;
+
+    const int N = 4;    // theta, v, x, y
+
+    const double velH = sqrt(dp0.vx * dp0.vx + dp0.vy * dp0.vy);
+
+    double y[N];
+    y[0] = atan2(-dp0.velD, velH);
+    y[1] = sqrt(dp0.velD * dp0.velD + velH * velH);
+    y[2] = 0;
+    y[3] = dp0.hMSL;
+
+    double dist2D = dp0.dist2D;
+    double dist3D = dp0.dist3D;
+    double prevX  = y[2];
+    double prevY  = y[3];
+
+    result.reserve(qMax(size(), 1));
+    result.resize(qMax(size(), 1));
+
+    DataPoint *out = result.data();
+    *out++ = dp0;
+
+    if (size() < 2)
+    {
+        result.resize(1);
+        return;
+    }
+
+    // Integrate in units of h, so gene i sits at s = i
+    const int sEnd = size() - 1;
+
+    double k1[N], k2[N], k3[N], k4[N], k5[N], k6[N], k7[N];
+    double tmp[N], next[N];
+
+    derivatives(0, y, k1, a, c, planformArea, mass);
+
+    double s = 0;
+    double step = 1;
+    int sample = 1;
+    int knot = 1;
+    bool done = false;
+
+    while (!done)
+    {
+        // Lift is only smooth between kinks, so never step across one
+        while (knot < sEnd
+               && (knot <= s
+                   || fabs(at(knot - 1) - 2 * at(knot) + at(knot + 1)) <= 1e-12))
+        {
+            ++knot;
+        }
+
+        const bool clipped = (s + step >= knot);
+        const double sNext = clipped ? knot : s + step;
+        const double ds = sNext - s;
+        const double dt = ds * h;
+
+        for (int j = 0; j < N; ++j) tmp[j] = y[j] + dt * a21 * k1[j];
+        derivatives(s + ds / 5, tmp, k2, a, c, planformArea, mass);
+
+        for (int j = 0; j < N; ++j) tmp[j] = y[j] + dt * (a31 * k1[j] + a32 * k2[j]);
+        derivatives(s + ds * 3 / 10, tmp, k3, a, c, planformArea, mass);
+
+        for (int j = 0; j < N; ++j) tmp[j] = y[j] + dt * (a41 * k1[j] + a42 * k2[j] + a43 * k3[j]);
+        derivatives(s + ds * 4 / 5, tmp, k4, a, c, planformArea, mass);
+
+        for (int j = 0; j < N; ++j) tmp[j] = y[j] + dt * (a51 * k1[j] + a52 * k2[j] + a53 * k3[j] + a54 * k4[j]);
+        derivatives(s + ds * 8 / 9, tmp, k5, a, c, planformArea, mass);
+
+        for (int j = 0; j < N; ++j) tmp[j] = y[j] + dt * (a61 * k1[j] + a62 * k2[j] + a63 * k3[j] + a64 * k4[j] + a65 * k5[j]);
+        derivatives(s + ds, tmp, k6, a, c, planformArea, mass);
+
+        for (int j = 0; j < N; ++j) next[j] = y[j] + dt * (a71 * k1[j] + a73 * k3[j] + a74 * k4[j] + a75 * k5[j] + a76 * k6[j]);
+        derivatives(s + ds, next, k7, a, c, planformArea, mass);
+
+        // Local error relative to the size of each state variable
+        double err = 0;
+        for (int j = 0; j < N; ++j)
+        {
+            const double e = dt * (e1 * k1[j] + e3 * k3[j] + e4 * k4[j] + e5 * k5[j] + e6 * k6[j] + e7 * k7[j]);
+            const double scale = tolerance * (1 + qMax(fabs(y[j]), fabs(next[j])));
+            err = qMax(err, fabs(e) / scale);
+        }
+
+        // Standard step size control with a safety factor
+        const double factor = (err > 0) ? qBound(0.2, 0.9 * pow(err, -0.2), 5.0) : 5.0;
+
+        if (err > 1 && ds > 1e-6)
+        {
+            step = ds * factor;
+            continue;
+        }
+
+        // Sample the continuous extension at each output time in this step
+        for (; sample <= sNext && !done; ++sample)
+        {
+            const double u = (sample - s) / ds;
+
+            double p[N];
+            for (int j = 0; j < N; ++j)
+            {
+                const double r1 = y[j];
+                const double r2 = next[j] - y[j];
+                const double r3 = dt * k1[j] - r2;
+                const double r4 = r2 - dt * k7[j] - r3;
+                const double r5 = dt * (d1 * k1[j] + d3 * k3[j] + d4 * k4[j] + d5 * k5[j] + d6 * k6[j] + d7 * k7[j]);
+                p[j] = r1 + u * (r2 + (1 - u) * (r3 + u * (r4 + (1 - u) * r5)));
+            }
+
+            // Add data point
+            DataPoint &pt = *out++;
+
+            pt.hasGeodetic = false;
+
+            pt.hMSL  = p[3];
+
+            pt.vx    = 0;
+            pt.vy    = p[1] * cos(p[0]);
+            pt.velD  = -p[1] * sin(p[0]);
+
+            pt.t = dp0.t + sample * h;
+            pt.x = p[2];
+            pt.y = 0;
+            pt.z = p[3] + dp0.z - dp0.hMSL;
+
+            const double dx = p[2] - prevX;
+            const double dy = p[3] - prevY;
+
+            dist2D += dx;
+            dist3D += sqrt(dx * dx + dy * dy);
+
+            prevX = p[2];
+            prevY = p[3];
+
+            pt.dist2D = dist2D;
+            pt.dist3D = dist3D;
+
+            pt.lift = lift(at(sample));
+            pt.drag = drag(at(sample), a, c);
+
+            if (pt.z < windowBottom || sample >= sEnd) done = true;
+        }
+
+        s = sNext;
+        for (int j = 0; j < N; ++j)
+        {
+            y[j]  = next[j];
+            k1[j] = k7[j];
+        }
+
+        // A step cut short at a kink says little about the next one
+        if (!clipped || factor < 1) step = ds * factor;
+    }
+
+    result.resize(out - result.constData());
+}
+
+void Genome::derivatives(
+        double s,
+        const double *state,
+        double *rate,
+        double a,
+        double c,
+        double planformArea,
+        double mass) const
+{
+    // Lift coefficient varies linearly between genes
+    const int i = qBound(0, (int) s, size() - 2);
+    const double cl = at(i) + (s - i) * (at(i + 1) - at(i));
+
+    const double theta = state[0];
+    const double v     = state[1];
+    const double x     = state[2];
+    const double y     = state[3];
+
+    const double airDensity = Atmosphere::standard().density(y);
+
+    rate[0] = dtheta_dt(theta, v, airDensity, lift(cl), planformArea, mass);
+    rate[1] =     dv_dt(theta, v, airDensity, drag(cl, a, c), planformArea, mass);
+    rate[2] =     dx_dt(theta, v, x, y);
+    rate[3] =     dy_dt(theta, v, x, y);
 }
 
 double Genome::dtheta_dt(
         double theta,
         double v,
-        double x,
-        double y,
+        double airDensity,
         double lift,
         double planformArea,
         double mass)
 {
-    // From https://en.wikipedia.org/wiki/Atmospheric_pressure#Altitude_variation
-    const double airPressure = SL_PRESSURE * pow(1 - LAPSE_RATE * y / SL_TEMP, A_GRAVITY * MM_AIR / GAS_CONST / LAPSE_RATE);
-
-    // From https://en.wikipedia.org/wiki/Lapse_rate
-    const double temperature = SL_TEMP - LAPSE_RATE * y;
-
-    // From https://en.wikipedia.org/wiki/Density_of_air
-    const double airDensity = airPressure / (GAS_CONST / MM_AIR) / temperature;
-
     // From https://en.wikipedia.org/wiki/Dynamic_pressure
     const double dynamicPressure = airDensity * v * v / 2;
 
@@ -266,21 +501,11 @@ double Genome::dtheta_dt(
 double Genome::dv_dt(
         double theta,
         double v,
-        double x,
-        double y,
+        double airDensity,
         double drag,
         double planformArea,
         double mass)
 {
-    // From https://en.wikipedia.org/wiki/Atmospheric_pressure#Altitude_variation
-    const double airPressure = SL_PRESSURE * pow(1 - LAPSE_RATE * y / SL_TEMP, A_GRAVITY * MM_AIR / GAS_CONST / LAPSE_RATE);
-
-    // From https://en.wikipedia.org/wiki/Lapse_rate
-    const double temperature = SL_TEMP - LAPSE_RATE * y;
-
-    // From https://en.wikipedia.org/wiki/Density_of_air
-    const double airDensity = airPressure / (GAS_CONST / MM_AIR) / temperature;
-
     // From https://en.wikipedia.org/wiki/Dynamic_pressure
     const double dynamicPressure = airDensity * v * v / 2;
 
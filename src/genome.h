@@ -29,29 +29,54 @@
 #include "datapoint.h"
 #include "mainwindow.h"
 
+class RandomStream;
+
 class Genome:
         public QVector< double >
 {
 public:
     Genome();
     Genome(const QVector< double > &rhs);
-    Genome(const Genome &p1, const Genome &p2, int k);
-    Genome(int genomeSize, int k, double minLift, double maxLift);
+    Genome(const Genome &p1, const Genome &p2, int k,
+           RandomStream &random);
+    Genome(int genomeSize, int k, double minLift, double maxLift,
+           RandomStream &random);
 
-    void mutate(int k, int kMin, double minLift, double maxLift);
+    void mutate(int k, int kMin, double minLift, double maxLift,
+                RandomStream &random);
     void truncate(int k);
     MainWindow::DataPoints simulate(double h, double a, double c,
                                   double planformArea, double mass,
-                                  const DataPoint &dp0, double windowBottom);
+                                  const DataPoint &dp0, double windowBottom) const;
+
+    // Same as above, writing into a buffer that keeps its allocation
+    // between calls
+    void simulate(double h, double a, double c,
+                  double planformArea, double mass,
+                  const DataPoint &dp0, double windowBottom,
+                  MainWindow::DataPoints &result) const;
+
+    // Integrates with adaptive Dormand-Prince 5(4) steps instead, keeping
+    // the local error per step below tolerance. Lift is interpolated
+    // between genes and the result is still sampled every h seconds.
+    void simulateAdaptive(double h, double a, double c,
+                          double planformArea, double mass,
+                          const DataPoint &dp0, double windowBottom,
+                          double tolerance,
+                          MainWindow::DataPoints &result) const;
 
 private:
-    static double dtheta_dt(double theta, double v, double x, double y, double lift,
+    static double dtheta_dt(double theta, double v, double airDensity, double lift,
                             double planformArea, double mass);
-    static double dv_dt(double theta, double v, double x, double y, double drag,
+    static double dv_dt(double theta, double v, double airDensity, double drag,
                         double planformArea, double mass);
     static double dx_dt(double theta, double v, double x, double y);
     static double dy_dt(double theta, double v, double x, double y);
 
+    void derivatives(double s, const double *state, double *rate,
+                     double a, double c, double planformArea,
+                     double mass) const;
+
     static double lift(double cl);
     static double drag(double cl, double a, double c);
 };
@@ -0,0 +1,166 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QObject>
+#include <QtAlgorithms>
+
+#include "flysightreader.h"
+#include "importtask.h"
+
+ImportTask::ImportTask(
+        const TrackProcessor &processor,
+        const TrackProcessor::Parameters &params,
+        const QSet< QString > &present):
+    mProcessor(processor),
+    mParams(params),
+    mPresent(present)
+{
+
+}
+
+ImportTask::Result ImportTask::operator()(
+        const QString &fileName) const
+{
+    Result result;
+
+    result.fileName = fileName;
+    result.valid = false;
+    result.present = false;
+
+    result.startTime = result.duration = result.samplePeriod = 0;
+    result.minLat = result.maxLat = 0;
+    result.minLon = result.maxLon = 0;
+
+    result.params = mParams;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        result.error = QObject::tr("Couldn't read file");
+        return result;
+    }
+
+    const qint64 size = file.size();
+    uchar *map = size > 0 ? file.map(0, size) : 0;
+
+    QByteArray bytes;
+    const char *begin;
+
+    if (map)
+    {
+        begin = (const char *) map;
+    }
+    else
+    {
+        bytes = file.readAll();
+        begin = bytes.constData();
+    }
+
+    const qint64 length = map ? size : bytes.size();
+
+    // Get hash
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(begin, length);
+    result.uniqueName = QString(hash.result().toHex());
+
+    // Nothing more to do if the file is already in the logbook
+    if (mPresent.contains(result.uniqueName))
+    {
+        if (map) file.unmap(map);
+
+        result.valid = true;
+        result.present = true;
+        return result;
+    }
+
+    // Read file data
+    QVector< DataPoint > data;
+    FlySightReader reader(begin, length);
+    reader.read(data);
+
+    if (map) file.unmap(map);
+
+    if (data.isEmpty())
+    {
+        result.error = QObject::tr("No data");
+        return result;
+    }
+
+    // Resolve ground and exit
+    mProcessor.process(data, result.params);
+
+    summarize(data,
+              result.startTime, result.duration, result.samplePeriod,
+              result.minLat, result.maxLat,
+              result.minLon, result.maxLon);
+
+    result.valid = true;
+    return result;
+}
+
+void ImportTask::summarize(
+        const QVector< DataPoint > &data,
+        qint64 &startTime,
+        qint64 &duration,
+        qint64 &samplePeriod,
+        int &minLat,
+        int &maxLat,
+        int &minLon,
+        int &maxLon)
+{
+    startTime = data.front().timestamp;
+    duration = data.back().timestamp - startTime;
+
+    minLat = 900000000;  maxLat = -900000000;
+    minLon = 1800000000; maxLon = -1800000000;
+
+    QVector< qint64 > dt;
+    for (int i = 0; i < data.size(); ++i)
+    {
+        if (i > 0)
+        {
+            dt.push_back(data[i].timestamp - data[i - 1].timestamp);
+        }
+
+        int lat = data[i].lat * 10000000;
+        int lon = data[i].lon * 10000000;
+
+        if (lat < minLat) minLat = lat;
+        if (lat > maxLat) maxLat = lat;
+        if (lon < minLon) minLon = lon;
+        if (lon > maxLon) maxLon = lon;
+    }
+
+    if (dt.isEmpty())
+    {
+        samplePeriod = 0;
+    }
+    else
+    {
+        qSort(dt);
+        samplePeriod = dt[dt.size() / 2];
+    }
+}
@@ -0,0 +1,76 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef IMPORTTASK_H
+#define IMPORTTASK_H
+
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include "datapoint.h"
+#include "trackprocessor.h"
+
+class ImportTask
+{
+public:
+    typedef struct {
+        QString fileName;
+        QString uniqueName;
+
+        bool    valid;          // File was read and hashed
+        bool    present;        // Already in the logbook, not parsed
+        QString error;
+
+        qint64  startTime;      // Logbook summary
+        qint64  duration;
+        qint64  samplePeriod;
+        int     minLat, maxLat;
+        int     minLon, maxLon;
+
+        TrackProcessor::Parameters params;
+    } Result;
+
+    typedef Result result_type;
+
+    ImportTask(const TrackProcessor &processor,
+               const TrackProcessor::Parameters &params,
+               const QSet< QString > &present);
+
+    // Hash, parse and summarize one file. Safe to run on any thread.
+    Result operator()(const QString &fileName) const;
+
+    static void summarize(const QVector< DataPoint > &data,
+                          qint64 &startTime, qint64 &duration,
+                          qint64 &samplePeriod,
+                          int &minLat, int &maxLat,
+                          int &minLon, int &maxLon);
+
+private:
+    TrackProcessor             mProcessor;
+    TrackProcessor::Parameters mParams;
+    QSet< QString >            mPresent;
+};
+
+#endif // IMPORTTASK_H
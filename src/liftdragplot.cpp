@@ -182,14 +182,18 @@ void LiftDragPlot::updatePlot()
     double s10 = 0, s01 = 0, s20 = 0, s11 = 0;
     double s21 = 0, s30 = 0, s40 = 0;
 
+    const TrackData &track = mMainWindow->track();
+
+    const double *tt = track.constData(TrackData::T);
+    const double *drag = track.constData(TrackData::Drag);
+    const double *lift = track.constData(TrackData::Lift);
+
     bool first = true;
     for (int i = start; i < end; ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
-
-        t.append(dp.t);
-        x.append(dp.drag);
-        y.append(dp.lift);
+        t.append(tt[i]);
+        x.append(drag[i]);
+        y.append(lift[i]);
 
         if (first)
         {
@@ -204,13 +208,13 @@ void LiftDragPlot::updatePlot()
             if (y.back() > yMax) yMax = y.back();
         }
 
-        s10 += dp.lift;
-        s01 += dp.drag;
-        s20 += dp.lift * dp.lift;
-        s11 += dp.lift * dp.drag;
-        s21 += dp.lift * dp.lift * dp.drag;
-        s30 += dp.lift * dp.lift * dp.lift;
-        s40 += dp.lift * dp.lift * dp.lift * dp.lift;
+        s10 += lift[i];
+        s01 += drag[i];
+        s20 += lift[i] * lift[i];
+        s11 += lift[i] * drag[i];
+        s21 += lift[i] * lift[i] * drag[i];
+        s30 += lift[i] * lift[i] * lift[i];
+        s40 += lift[i] * lift[i] * lift[i] * lift[i];
     }
 
     QCPCurve *curve = new QCPCurve(xAxis, yAxis);
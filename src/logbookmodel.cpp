@@ -0,0 +1,531 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "logbookmodel.h"
+
+#include <QApplication>
+#include <QMessageBox>
+#include <QRegExp>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStyle>
+
+#include <math.h>
+
+#include "common.h"
+#include "mainwindow.h"
+
+namespace
+{
+
+// Number of rows read from the database at a time
+const int PAGE_SIZE = 256;
+
+// Wind direction as a monotonic function of atan2(-wind_e, -wind_n) which
+// SQLite can evaluate without trigonometry; ranges over [0, 4)
+const char *WIND_DIR_KEY =
+        "case "
+        "when coalesce(wind_e, 0) = 0 and coalesce(wind_n, 0) = 0 then 0 "
+        "when -wind_e >= 0 and -wind_n > 0 then -wind_e / (abs(wind_e) + abs(wind_n)) "
+        "when -wind_e > 0 then 1 + wind_n / (abs(wind_e) + abs(wind_n)) "
+        "when -wind_n < 0 then 2 + wind_e / (abs(wind_e) + abs(wind_n)) "
+        "else 3 - wind_n / (abs(wind_e) + abs(wind_n)) "
+        "end";
+
+QString sortKey(
+        int column)
+{
+    switch (column)
+    {
+    case LogbookModel::FileName:     return "file_name";
+    case LogbookModel::Description:  return "description";
+    case LogbookModel::StartTime:    return "start_time";
+    case LogbookModel::Duration:     return "duration";
+    case LogbookModel::SamplePeriod: return "sample_period";
+    case LogbookModel::MinLat:       return "min_lat";
+    case LogbookModel::MaxLat:       return "max_lat";
+    case LogbookModel::MinLon:       return "min_lon";
+    case LogbookModel::MaxLon:       return "max_lon";
+    case LogbookModel::ImportTime:   return "import_time";
+    case LogbookModel::ExitTime:     return "exit";
+    case LogbookModel::Ground:       return "ground";
+    case LogbookModel::Course:       return "course";
+    case LogbookModel::WindSpeed:    return "coalesce(wind_e * wind_e + wind_n * wind_n, 0)";
+    case LogbookModel::WindDir:      return WIND_DIR_KEY;
+    case LogbookModel::RangeLower:   return "t_min";
+    case LogbookModel::RangeUpper:   return "t_max";
+    default:                         return "id";
+    }
+}
+
+QString timeText(
+        const QDateTime &dateTime)
+{
+    return dateTime.toLocalTime().toString("yyyy/MM/dd h:mm A");
+}
+
+QString durationText(
+        qint64 duration)
+{
+    if (duration < 3600000)
+    {
+        return QString("%1:%2").arg(duration / 60000)
+                               .arg((duration / 1000) % 60, 2, 10, QChar('0'));
+    }
+    else
+    {
+        return QString("%1:%2:%3").arg(duration / 3600000)
+                                  .arg((duration / 60000) % 60, 2, 10, QChar('0'))
+                                  .arg((duration / 1000) % 60, 2, 10, QChar('0'));
+    }
+}
+
+} // namespace
+
+LogbookModel::LogbookModel(
+        MainWindow *mainWindow,
+        QObject *parent):
+    QAbstractTableModel(parent),
+    mMainWindow(mainWindow),
+    mAtEnd(false),
+    mSortColumn(Id),
+    mSortOrder(Qt::AscendingOrder)
+{
+
+}
+
+int LogbookModel::rowCount(
+        const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return mRows.size();
+}
+
+int LogbookModel::columnCount(
+        const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return colLast;
+}
+
+QVariant LogbookModel::data(
+        const QModelIndex &index,
+        int role) const
+{
+    if (!index.isValid() || index.row() >= mRows.size()) return QVariant();
+
+    const Row &row = mRows[index.row()];
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return displayData(row, index.column());
+    case Qt::DecorationRole:
+        if (index.column() == Current && row.fileName == mMainWindow->trackName())
+        {
+            return QApplication::style()->standardIcon(QStyle::SP_MediaPlay);
+        }
+        break;
+    case Qt::CheckStateRole:
+        if (index.column() == Checked)
+        {
+            return mMainWindow->trackChecked(row.fileName) ? Qt::Checked : Qt::Unchecked;
+        }
+        break;
+    }
+
+    return QVariant();
+}
+
+QVariant LogbookModel::displayData(
+        const Row &row,
+        int column) const
+{
+    switch (column)
+    {
+    case Id:           return row.id;
+    case FileName:     return row.fileName;
+    case Description:  return row.description;
+    case StartTime:    return timeText(row.startTime);
+    case Duration:     return durationText(row.duration);
+    case SamplePeriod: return row.samplePeriod;
+    case MinLat:       return row.minLat;
+    case MaxLat:       return row.maxLat;
+    case MinLon:       return row.minLon;
+    case MaxLon:       return row.maxLon;
+    case ImportTime:   return timeText(row.importTime);
+    case ExitTime:     return timeText(row.exitTime);
+    case Ground:       return QString::number(row.ground, 'f', 3);
+    case Course:       return QString::number(row.course, 'f', 5);
+    case WindSpeed:    return QString::number(row.windSpeed, 'f', 2);
+    case WindDir:      return QString::number(row.windDir, 'f', 5);
+    case RangeLower:   return timeText(row.rangeLower);
+    case RangeUpper:   return timeText(row.rangeUpper);
+    default:           return QVariant();
+    }
+}
+
+bool LogbookModel::setData(
+        const QModelIndex &index,
+        const QVariant &value,
+        int role)
+{
+    if (!index.isValid() || index.row() >= mRows.size()) return false;
+
+    // Copy the name since the row may be refreshed by the calls below
+    const QString fileName = mRows[index.row()].fileName;
+
+    if (role == Qt::CheckStateRole && index.column() == Checked)
+    {
+        // Update check state
+        mMainWindow->setTrackChecked(fileName, value.toInt() == Qt::Checked);
+        emit dataChanged(index, index);
+        return true;
+    }
+
+    if (role != Qt::EditRole) return false;
+
+    // The main window reports the new value back through trackChanged
+    switch (index.column())
+    {
+    case Description:
+        mMainWindow->setTrackDescription(fileName, value.toString());
+        return true;
+    case Ground:
+        mMainWindow->setTrackGround(fileName, value.toDouble());
+        return true;
+    case WindSpeed:
+        mMainWindow->setTrackWindSpeed(fileName, value.toDouble());
+        return true;
+    case WindDir:
+        mMainWindow->setTrackWindDir(fileName, value.toDouble());
+        return true;
+    default:
+        return false;
+    }
+}
+
+QVariant LogbookModel::headerData(
+        int section,
+        Qt::Orientation orientation,
+        int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section)
+    {
+    case Id:           return tr("ID");
+    case FileName:     return tr("File Name");
+    case Description:  return tr("Description");
+    case StartTime:    return tr("Start Time");
+    case Duration:     return tr("Duration");
+    case SamplePeriod: return tr("Sample Period");
+    case MinLat:       return tr("Minimum Latitude");
+    case MaxLat:       return tr("Maximum Latitude");
+    case MinLon:       return tr("Minimum Longitude");
+    case MaxLon:       return tr("Maximum Longitude");
+    case ImportTime:   return tr("Import Time");
+    case ExitTime:     return tr("Exit Time");
+    case Ground:       return tr("Ground Elevation");
+    case Course:       return tr("Course Angle");
+    case WindSpeed:    return tr("Wind Speed");
+    case WindDir:      return tr("Wind Direction");
+    case RangeLower:   return tr("Range Lower");
+    case RangeUpper:   return tr("Range Upper");
+    default:           return QString();
+    }
+}
+
+Qt::ItemFlags LogbookModel::flags(
+        const QModelIndex &index) const
+{
+    Qt::ItemFlags flags = QAbstractTableModel::flags(index);
+    if (!index.isValid()) return flags;
+
+    switch (index.column())
+    {
+    case Checked:
+        flags |= Qt::ItemIsUserCheckable;
+        break;
+    case Description:
+    case Ground:
+    case WindSpeed:
+    case WindDir:
+        flags |= Qt::ItemIsEditable;
+        break;
+    }
+
+    return flags;
+}
+
+bool LogbookModel::canFetchMore(
+        const QModelIndex &parent) const
+{
+    if (parent.isValid()) return false;
+    return !mAtEnd;
+}
+
+void LogbookModel::fetchMore(
+        const QModelIndex &parent)
+{
+    if (parent.isValid() || mAtEnd) return;
+
+    QVector< Row > rows;
+    if (!readRows(mRows.size(), PAGE_SIZE, rows))
+    {
+        mAtEnd = true;
+        return;
+    }
+
+    mAtEnd = (rows.size() < PAGE_SIZE);
+
+    // Skip rows already shown, e.g. when an edit moved a row across pages
+    QVector< Row > newRows;
+    foreach (const Row &row, rows)
+    {
+        if (!mRowIndex.contains(row.fileName)) newRows.append(row);
+    }
+
+    if (newRows.isEmpty()) return;
+
+    const int first = mRows.size();
+    beginInsertRows(QModelIndex(), first, first + newRows.size() - 1);
+    foreach (const Row &row, newRows)
+    {
+        mRowIndex.insert(row.fileName, mRows.size());
+        mRows.append(row);
+    }
+    endInsertRows();
+}
+
+void LogbookModel::sort(
+        int column,
+        Qt::SortOrder order)
+{
+    if (column == mSortColumn && order == mSortOrder) return;
+
+    mSortColumn = column;
+    mSortOrder = order;
+
+    refresh();
+}
+
+void LogbookModel::setFilter(
+        const QString &text)
+{
+    mFilter = text.split(QRegExp("\\s"), QString::SkipEmptyParts);
+    refresh();
+}
+
+QString LogbookModel::fileName(
+        int row) const
+{
+    if (row < 0 || row >= mRows.size()) return QString();
+    return mRows[row].fileName;
+}
+
+void LogbookModel::refresh()
+{
+    beginResetModel();
+
+    mRows.clear();
+    mRowIndex.clear();
+    mAtEnd = false;
+
+    endResetModel();
+
+    // Read the first page straight away
+    fetchMore(QModelIndex());
+}
+
+void LogbookModel::refreshTrack(
+        const QString &trackName)
+{
+    if (!mRowIndex.contains(trackName)) return;
+
+    QSqlDatabase db = QSqlDatabase::database("flysight");
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    query.prepare(selectText("where file_name = :name"));
+    query.bindValue(":name", trackName);
+
+    if (!query.exec())
+    {
+        QSqlError err = query.lastError();
+        QMessageBox::critical(0, tr("Query failed"), err.text());
+        return;
+    }
+
+    if (!query.next()) return;
+
+    const int i = mRowIndex.value(trackName);
+    const Row row = readRow(query);
+
+    // Pages are read by offset, so a row that moved in the sort order or
+    // left the filter would shift the ones not yet read; start over instead
+    const bool moved = !sameSortKey(mRows[i], row)
+            || (!mFilter.isEmpty() && mRows[i].description != row.description);
+    if (!mAtEnd && moved)
+    {
+        refresh();
+        return;
+    }
+
+    mRows[i] = row;
+
+    emit dataChanged(index(i, 0), index(i, colLast - 1));
+}
+
+QString LogbookModel::selectText(
+        const QString &whereText) const
+{
+    return QString("select id, file_name, description, start_time, duration, "
+                   "sample_period, min_lat, max_lat, min_lon, max_lon, "
+                   "import_time, exit, ground, course, wind_e, wind_n, "
+                   "t_min, t_max from files %1").arg(whereText);
+}
+
+QString LogbookModel::whereText() const
+{
+    QString text;
+    for (int i = 0; i < mFilter.size(); ++i)
+    {
+        if (i == 0) text += "where ";
+        else        text += "and ";
+
+        text += QString("lower(description) like lower(:t%1) ").arg(i);
+    }
+    return text;
+}
+
+void LogbookModel::bindFilter(
+        QSqlQuery &query) const
+{
+    for (int i = 0; i < mFilter.size(); ++i)
+    {
+        query.bindValue(QString(":t%1").arg(i), "%" + mFilter[i] + "%");
+    }
+}
+
+bool LogbookModel::readRows(
+        int offset,
+        int limit,
+        QVector< Row > &rows)
+{
+    QSqlDatabase db = QSqlDatabase::database("flysight");
+    if (!db.isOpen()) return false;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // Ties are broken by id so pages don't overlap
+    const QString direction = (mSortOrder == Qt::AscendingOrder) ? "asc" : "desc";
+    query.prepare(selectText(whereText())
+                  + QString("order by %1 %2, id %2 limit :limit offset :offset")
+                  .arg(sortKey(mSortColumn)).arg(direction));
+
+    bindFilter(query);
+    query.bindValue(":limit", limit);
+    query.bindValue(":offset", offset);
+
+    if (!query.exec())
+    {
+        QSqlError err = query.lastError();
+        QMessageBox::critical(0, tr("Query failed"), err.text());
+        return false;
+    }
+
+    while (query.next())
+    {
+        rows.append(readRow(query));
+    }
+
+    return true;
+}
+
+LogbookModel::Row LogbookModel::readRow(
+        const QSqlQuery &query)
+{
+    Row row;
+
+    row.id           = query.value(0).toLongLong();
+    row.fileName     = query.value(1).toString();
+    row.description  = query.value(2).toString();
+    row.startTime    = QDateTime::fromString(query.value(3).toString(), Qt::ISODate);
+    row.duration     = query.value(4).toString().toLongLong();
+    row.samplePeriod = query.value(5).toString().toLongLong();
+    row.minLat       = query.value(6).toInt();
+    row.maxLat       = query.value(7).toInt();
+    row.minLon       = query.value(8).toInt();
+    row.maxLon       = query.value(9).toInt();
+    row.importTime   = QDateTime::fromString(query.value(10).toString(), Qt::ISODate);
+    row.exitTime     = QDateTime::fromString(query.value(11).toString(), Qt::ISODate);
+    row.ground       = query.value(12).toString().toDouble();
+    row.course       = query.value(13).toString().toDouble();
+
+    const double windE = query.value(14).toString().toDouble();
+    const double windN = query.value(15).toString().toDouble();
+
+    row.windSpeed = sqrt(windE * windE + windN * windN);
+    row.windDir = atan2(-windE, -windN) / PI * 180;
+    if (row.windDir < 0) row.windDir += 360;
+
+    row.rangeLower   = QDateTime::fromString(query.value(16).toString(), Qt::ISODate);
+    row.rangeUpper   = QDateTime::fromString(query.value(17).toString(), Qt::ISODate);
+
+    return row;
+}
+
+bool LogbookModel::sameSortKey(
+        const Row &row1,
+        const Row &row2) const
+{
+    switch (mSortColumn)
+    {
+    case FileName:     return row1.fileName == row2.fileName;
+    case Description:  return row1.description == row2.description;
+    case StartTime:    return row1.startTime == row2.startTime;
+    case Duration:     return row1.duration == row2.duration;
+    case SamplePeriod: return row1.samplePeriod == row2.samplePeriod;
+    case MinLat:       return row1.minLat == row2.minLat;
+    case MaxLat:       return row1.maxLat == row2.maxLat;
+    case MinLon:       return row1.minLon == row2.minLon;
+    case MaxLon:       return row1.maxLon == row2.maxLon;
+    case ImportTime:   return row1.importTime == row2.importTime;
+    case ExitTime:     return row1.exitTime == row2.exitTime;
+    case Ground:       return row1.ground == row2.ground;
+    case Course:       return row1.course == row2.course;
+    case WindSpeed:    return row1.windSpeed == row2.windSpeed;
+    case WindDir:      return row1.windDir == row2.windDir;
+    case RangeLower:   return row1.rangeLower == row2.rangeLower;
+    case RangeUpper:   return row1.rangeUpper == row2.rangeUpper;
+    default:           return row1.id == row2.id;
+    }
+}
@@ -0,0 +1,129 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef LOGBOOKMODEL_H
+#define LOGBOOKMODEL_H
+
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+class MainWindow;
+class QSqlQuery;
+
+class LogbookModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    typedef enum {
+        Current = 0,
+        Checked,
+        Id,
+        FileName,
+        Description,
+        StartTime,
+        Duration,
+        SamplePeriod,
+        MinLat,
+        MaxLat,
+        MinLon,
+        MaxLon,
+        ImportTime,
+        ExitTime,
+        Ground,
+        Course,
+        WindSpeed,
+        WindDir,
+        RangeLower,
+        RangeUpper,
+        colLast
+    } Column;
+
+    explicit LogbookModel(MainWindow *mainWindow, QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex &index) const;
+
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+    void setFilter(const QString &text);
+    QString fileName(int row) const;
+
+public slots:
+    void refresh();
+    void refreshTrack(const QString &trackName);
+
+private:
+    typedef struct {
+        qint64    id;
+        QString   fileName;
+        QString   description;
+        QDateTime startTime;
+        qint64    duration;
+        qint64    samplePeriod;
+        int       minLat, maxLat;
+        int       minLon, maxLon;
+        QDateTime importTime;
+        QDateTime exitTime;
+        double    ground;
+        double    course;
+        double    windSpeed;
+        double    windDir;
+        QDateTime rangeLower;
+        QDateTime rangeUpper;
+    } Row;
+
+    MainWindow           *mMainWindow;
+
+    QVector< Row >        mRows;
+    QHash< QString, int > mRowIndex;
+    bool                  mAtEnd;
+
+    QStringList           mFilter;
+    int                   mSortColumn;
+    Qt::SortOrder         mSortOrder;
+
+    QString selectText(const QString &whereText) const;
+    QString whereText() const;
+    void bindFilter(QSqlQuery &query) const;
+
+    bool readRows(int offset, int limit, QVector< Row > &rows);
+    static Row readRow(const QSqlQuery &query);
+    bool sameSortKey(const Row &row1, const Row &row2) const;
+
+    QVariant displayData(const Row &row, int column) const;
+};
+
+#endif // LOGBOOKMODEL_H
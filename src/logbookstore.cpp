@@ -0,0 +1,431 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include <QDateTime>
+#include <QObject>
+#include <QSqlError>
+
+#include "logbookstore.h"
+
+// Columns of the files table. Column names cannot be bound as parameters,
+// so only these are ever placed in SQL text.
+static const char *const columnNames[] = {
+    "id",
+    "file_name",
+    "description",
+    "start_time",
+    "duration",
+    "sample_period",
+    "min_lat",
+    "max_lat",
+    "min_lon",
+    "max_lon",
+    "import_time",
+    "exit",
+    "ground",
+    "course",
+    "wind_e",
+    "wind_n",
+    "t_min",
+    "t_max",
+    0
+};
+
+LogbookStore::LogbookStore():
+    mTransactionDepth(0)
+{
+
+}
+
+LogbookStore::~LogbookStore()
+{
+    close();
+}
+
+bool LogbookStore::open(
+        const QString &fileName)
+{
+    close();
+
+    mDatabase = QSqlDatabase::addDatabase("QSQLITE", "flysight");
+    mDatabase.setDatabaseName(fileName);
+
+    if (!mDatabase.open())
+    {
+        mLastError = mDatabase.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(mDatabase);
+
+    // Readers don't block the writer and commits are cheaper
+    query.exec("pragma journal_mode=wal");
+    query.exec("pragma synchronous=normal");
+
+    if (!mDatabase.tables().contains("files"))
+    {
+        // Create table
+        if (!query.exec(QString("create table files ("
+                                    "id integer primary key, "
+                                    "file_name text, "
+                                    "description text, "
+                                    "start_time text, "
+                                    "duration integer, "
+                                    "sample_period integer, "
+                                    "min_lat integer, "
+                                    "max_lat integer, "
+                                    "min_lon integer, "
+                                    "max_lon integer, "
+                                    "import_time text)")))
+        {
+            mLastError = query.lastError().text();
+            return false;
+        }
+    }
+
+    // Add exit, ground and course
+    query.exec("alter table files add column exit text");
+    query.exec("alter table files add column ground real");
+    query.exec("alter table files add column course real");
+
+    // Add wind speed and direction
+    query.exec("alter table files add column wind_e real");
+    query.exec("alter table files add column wind_n real");
+
+    // Add zoom range
+    query.exec("alter table files add column t_min real");
+    query.exec("alter table files add column t_max real");
+
+    // Tracks are always looked up by file name
+    if (!query.exec("create index if not exists files_file_name on files (file_name)"))
+    {
+        mLastError = query.lastError().text();
+        return false;
+    }
+
+    // Optimization results
+    if (!query.exec("create table if not exists optimal ("
+                        "file_name text, "
+                        "scoring_mode integer, "
+                        "actual_score real, "
+                        "optimal_score real, "
+                        "trajectory blob, "
+                        "optimize_time text, "
+                        "primary key (file_name, scoring_mode))"))
+    {
+        mLastError = query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+void LogbookStore::close()
+{
+    // Prepared statements must go before the connection
+    mQueries.clear();
+    mTransactionDepth = 0;
+
+    if (mDatabase.isValid())
+    {
+        mDatabase.close();
+        mDatabase = QSqlDatabase();
+        QSqlDatabase::removeDatabase("flysight");
+    }
+}
+
+bool LogbookStore::transaction()
+{
+    if (mTransactionDepth++ > 0) return true;
+
+    if (!mDatabase.transaction())
+    {
+        mTransactionDepth = 0;
+        mLastError = mDatabase.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool LogbookStore::commit()
+{
+    if (mTransactionDepth == 0 || --mTransactionDepth > 0) return true;
+
+    if (!mDatabase.commit())
+    {
+        mLastError = mDatabase.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool LogbookStore::rollback()
+{
+    if (mTransactionDepth == 0) return true;
+
+    // Abandons the outermost transaction
+    mTransactionDepth = 0;
+
+    if (!mDatabase.rollback())
+    {
+        mLastError = mDatabase.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool LogbookStore::fileNames(
+        QSet< QString > &names)
+{
+    QSqlQuery query;
+    if (!prepare("select file_name from files", query)) return false;
+    if (!exec(query)) return false;
+
+    while (query.next())
+    {
+        names.insert(query.value(0).toString());
+    }
+
+    query.finish();
+    return true;
+}
+
+bool LogbookStore::contains(
+        const QString &trackName,
+        bool &present)
+{
+    QSqlQuery query;
+    if (!prepare("select 1 from files where file_name=:name", query)) return false;
+
+    query.bindValue(":name", trackName);
+    if (!exec(query)) return false;
+
+    present = query.next();
+
+    query.finish();
+    return true;
+}
+
+bool LogbookStore::insertTrack(
+        const QString &trackName,
+        const QStringList &columns,
+        const QVariantList &values)
+{
+    if (!checkColumns(columns)) return false;
+
+    QString names = "file_name";
+    QString params = ":name";
+
+    for (int i = 0; i < columns.size(); ++i)
+    {
+        names += ", " + columns[i];
+        params += QString(", :v%1").arg(i);
+    }
+
+    QSqlQuery query;
+    if (!prepare(QString("insert into files (%1) values (%2)")
+                 .arg(names).arg(params), query)) return false;
+
+    query.bindValue(":name", trackName);
+    for (int i = 0; i < columns.size(); ++i)
+    {
+        query.bindValue(QString(":v%1").arg(i), values[i]);
+    }
+
+    return exec(query);
+}
+
+bool LogbookStore::removeTrack(
+        const QString &trackName)
+{
+    QSqlQuery files, optimal;
+    if (!prepare("delete from files where file_name=:name", files)) return false;
+    if (!prepare("delete from optimal where file_name=:name", optimal)) return false;
+
+    files.bindValue(":name", trackName);
+    optimal.bindValue(":name", trackName);
+
+    // Optimization results go with the track
+    if (!transaction()) return false;
+
+    if (!exec(files) || !exec(optimal))
+    {
+        const QString error = mLastError;
+        rollback();
+        mLastError = error;
+        return false;
+    }
+
+    return commit();
+}
+
+bool LogbookStore::value(
+        const QString &trackName,
+        const QString &column,
+        QVariant &value)
+{
+    if (!checkColumns(QStringList() << column)) return false;
+
+    QSqlQuery query;
+    if (!prepare(QString("select %1 from files where file_name=:name")
+                 .arg(column), query)) return false;
+
+    query.bindValue(":name", trackName);
+    if (!exec(query)) return false;
+
+    value = query.next() ? query.value(0) : QVariant();
+
+    query.finish();
+    return true;
+}
+
+bool LogbookStore::setValue(
+        const QString &trackName,
+        const QString &column,
+        const QVariant &value,
+        bool &changed)
+{
+    if (!checkColumns(QStringList() << column)) return false;
+
+    // Only touch the row if the value is different
+    QSqlQuery query;
+    if (!prepare(QString("update files set %1=:value "
+                         "where file_name=:name and %1 is not :old")
+                 .arg(column), query)) return false;
+
+    query.bindValue(":value", value);
+    query.bindValue(":name", trackName);
+    query.bindValue(":old", value);
+    if (!exec(query)) return false;
+
+    if (query.numRowsAffected() > 0) changed = true;
+    return true;
+}
+
+bool LogbookStore::setValues(
+        const QString &trackName,
+        const QStringList &columns,
+        const QVariantList &values,
+        bool &changed)
+{
+    if (!transaction()) return false;
+
+    for (int i = 0; i < columns.size(); ++i)
+    {
+        if (!setValue(trackName, columns[i], values[i], changed))
+        {
+            const QString error = mLastError;
+            rollback();
+            mLastError = error;
+            return false;
+        }
+    }
+
+    return commit();
+}
+
+bool LogbookStore::setOptimal(
+        const QString &trackName,
+        int scoringMode,
+        double actualScore,
+        double optimalScore,
+        const QByteArray &trajectory)
+{
+    QSqlQuery query;
+    if (!prepare("insert or replace into optimal "
+                 "(file_name, scoring_mode, actual_score, optimal_score, trajectory, optimize_time) "
+                 "values (:name, :mode, :actual, :optimal, :trajectory, :time)", query)) return false;
+
+    query.bindValue(":name", trackName);
+    query.bindValue(":mode", scoringMode);
+    query.bindValue(":actual", actualScore);
+    query.bindValue(":optimal", optimalScore);
+    query.bindValue(":trajectory", trajectory);
+    query.bindValue(":time", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+
+    return exec(query);
+}
+
+bool LogbookStore::isColumn(
+        const QString &column)
+{
+    for (int i = 0; columnNames[i]; ++i)
+    {
+        if (column == columnNames[i]) return true;
+    }
+
+    return false;
+}
+
+bool LogbookStore::prepare(
+        const QString &sql,
+        QSqlQuery &query)
+{
+    QHash< QString, QSqlQuery >::const_iterator p = mQueries.constFind(sql);
+    if (p != mQueries.constEnd())
+    {
+        query = p.value();
+        return true;
+    }
+
+    query = QSqlQuery(mDatabase);
+    if (!query.prepare(sql))
+    {
+        mLastError = query.lastError().text();
+        return false;
+    }
+
+    mQueries.insert(sql, query);
+    return true;
+}
+
+bool LogbookStore::exec(
+        QSqlQuery &query)
+{
+    if (!query.exec())
+    {
+        mLastError = query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool LogbookStore::checkColumns(
+        const QStringList &columns)
+{
+    foreach (const QString &column, columns)
+    {
+        if (!isColumn(column))
+        {
+            mLastError = QObject::tr("Unknown column %1").arg(column);
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef LOGBOOKSTORE_H
+#define LOGBOOKSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+class LogbookStore
+{
+public:
+    LogbookStore();
+    ~LogbookStore();
+
+    // Open or create the logbook. All methods return false on failure
+    // and leave a message in lastError().
+    bool open(const QString &fileName);
+    void close();
+
+    QSqlDatabase database() const { return mDatabase; }
+    QString lastError() const { return mLastError; }
+
+    // Nested calls join the outermost transaction
+    bool transaction();
+    bool commit();
+    bool rollback();
+
+    bool fileNames(QSet< QString > &names);
+    bool contains(const QString &trackName, bool &present);
+
+    bool insertTrack(const QString &trackName,
+                     const QStringList &columns = QStringList(),
+                     const QVariantList &values = QVariantList());
+    bool removeTrack(const QString &trackName);
+
+    // Value is null if the track or column value does not exist
+    bool value(const QString &trackName, const QString &column,
+               QVariant &value);
+
+    // Changed is set if any stored value was different
+    bool setValue(const QString &trackName, const QString &column,
+                  const QVariant &value, bool &changed);
+    bool setValues(const QString &trackName, const QStringList &columns,
+                   const QVariantList &values, bool &changed);
+
+    // Best trajectory found by the optimizer for a track and scoring mode,
+    // replacing any earlier result
+    bool setOptimal(const QString &trackName, int scoringMode,
+                    double actualScore, double optimalScore,
+                    const QByteArray &trajectory);
+
+    static bool isColumn(const QString &column);
+
+private:
+    QSqlDatabase               mDatabase;
+    QHash< QString, QSqlQuery > mQueries;
+    int                        mTransactionDepth;
+    QString                    mLastError;
+
+    bool prepare(const QString &sql, QSqlQuery &query);
+    bool exec(QSqlQuery &query);
+    bool checkColumns(const QStringList &columns);
+};
+
+#endif // LOGBOOKSTORE_H
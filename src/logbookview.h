@@ -30,8 +30,9 @@ namespace Ui {
     class LogbookView;
 }
 
+class LogbookModel;
 class MainWindow;
-class QTableWidgetItem;
+class QModelIndex;
 
 class LogbookView : public QWidget
 {
@@ -49,16 +50,14 @@ protected:
 private:
     Ui::LogbookView *ui;
     MainWindow      *mMainWindow;
-
-    bool             suspendItemChanged;
+    LogbookModel    *mModel;
 
 public slots:
     void updateView();
 
 private slots:
-    void onDoubleClick(int row, int column);
+    void onDoubleClick(const QModelIndex &index);
     void onSelectionChanged();
-    void onItemChanged(QTableWidgetItem *item);
     void onSearchTextChanged(const QString &text);
     void onSearchTextReturn();
 };
@@ -25,30 +25,31 @@
 #include "ui_mainwindow.h"
 
 #include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDockWidget>
 #include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QMessageBox>
 #include <QProgressDialog>
 #include <QSettings>
 #include <QShortcut>
 #include <QSqlDatabase>
-#include <QSqlError>
-#include <QSqlQuery>
 #include <QStandardPaths>
-#include <QTemporaryFile>
 #include <QTextStream>
 #include <QThread>
+#include <QtConcurrent>
 
 #include <math.h>
 
-#include "GeographicLib/Geodesic.hpp"
-
 #include "common.h"
 #include "configdialog.h"
 #include "dataview.h"
 #include "flarescoring.h"
+#include "flysightreader.h"
+#include "importtask.h"
 #include "importworker.h"
 #include "liftdragplot.h"
 #include "logbookview.h"
@@ -59,18 +60,18 @@
 #include "ppcscoring.h"
 #include "scoringview.h"
 #include "speedscoring.h"
+#include "trackcache.h"
 #include "videoview.h"
 #include "wideopendistancescoring.h"
 #include "wideopenspeedscoring.h"
 #include "windplot.h"
 
-using namespace GeographicLib;
-
 MainWindow::MainWindow(
         QWidget *parent):
 
     QMainWindow(parent),
     m_ui(new Ui::MainWindow),
+    mTrackValid(false),
     mMarkActive(false),
     m_viewDataRotation(0),
     m_units(PlotValue::Imperial),
@@ -83,16 +84,23 @@ MainWindow::MainWindow(
     m_maxLift(0.5),
     m_maxLD(3.0),
     m_simulationTime(120),
+    mOptimizationSeed(0),
+    mOptimizationEngine(Genetic),
     mLineThickness(0),
     mWindE(0),
     mWindN(0),
     mWindAdjustment(false),
     mScoringMode(PPC),
     mGroundReference(Automatic),
-    mFixedReference(0)
+    mFixedReference(0),
+    mProcessor(4)
 {
     m_ui->setupUi(this);
 
+    // Column view must be refreshed before any view redraws
+    connect(this, SIGNAL(dataChanged()),
+            this, SLOT(invalidateTrack()));
+
     // Initialize scoring methods
     mScoringMethods.append(new PPCScoring(this));
     mScoringMethods.append(new SpeedScoring(this));
@@ -188,9 +196,35 @@ MainWindow::MainWindow(
 
 MainWindow::~MainWindow()
 {
+    // In case the window is destroyed without being closed first
+    ScoringMethod::stopOptimizations();
+
     delete m_ui;
 }
 
+const TrackData &MainWindow::track() const
+{
+    if (!mTrackValid)
+    {
+        mTrack.assign(m_data);
+        mTrackValid = true;
+    }
+
+    return mTrack;
+}
+
+const QVector< double > &MainWindow::plotValues(
+        const PlotValue *value) const
+{
+    return mChannelCache.values(track(), m_data, value, m_units);
+}
+
+void MainWindow::invalidateTrack()
+{
+    mTrackValid = false;
+    mChannelCache.clear();
+}
+
 void MainWindow::writeSettings()
 {
     QSettings settings("FlySight", "Viewer");
@@ -206,6 +240,8 @@ void MainWindow::writeSettings()
         settings.setValue("maxLift", m_maxLift);
         settings.setValue("maxLD", m_maxLD);
         settings.setValue("simulationTime", m_simulationTime);
+        settings.setValue("optimizationSeed", mOptimizationSeed);
+        settings.setValue("optimizationEngine", mOptimizationEngine);
         settings.setValue("lineThickness", mLineThickness);
         settings.setValue("windE", mWindE);
         settings.setValue("windN", mWindN);
@@ -213,6 +249,7 @@ void MainWindow::writeSettings()
         settings.setValue("groundReference", mGroundReference);
         settings.setValue("fixedReference", mFixedReference);
         settings.setValue("databasePath", mDatabasePath);
+        settings.setValue("slopeHalfWidth", mProcessor.halfWidth());
     settings.endGroup();
 }
 
@@ -229,6 +266,9 @@ void MainWindow::readSettings()
         m_maxLift = settings.value("maxLift", m_maxLift).toDouble();
         m_maxLD = settings.value("maxLD", m_maxLD).toDouble();
         m_simulationTime = settings.value("simulationTime", m_simulationTime).toInt();
+        mOptimizationSeed = settings.value("optimizationSeed", mOptimizationSeed).toULongLong();
+        mOptimizationEngine = (OptimizationEngine) settings.value("optimizationEngine", mOptimizationEngine).toInt();
+        if (mOptimizationEngine < 0 || mOptimizationEngine >= oeLast) mOptimizationEngine = Genetic;
         mLineThickness = settings.value("lineThickness", mLineThickness).toDouble();
         mWindE = settings.value("windE", mWindE).toDouble();
         mWindN = settings.value("windN", mWindN).toDouble();
@@ -238,6 +278,7 @@ void MainWindow::readSettings()
         mDatabasePath = settings.value("databasePath",
                                        QStandardPaths::writableLocation(
                                            QStandardPaths::DocumentsLocation)).toString();
+        mProcessor.setHalfWidth(settings.value("slopeHalfWidth", mProcessor.halfWidth()).toInt());
     settings.endGroup();
 }
 
@@ -246,51 +287,10 @@ void MainWindow::initDatabase()
     QDir(mDatabasePath).mkpath("FlySight");
     QString path = QDir(mDatabasePath).filePath("FlySight/FlySight.db");
 
-    mDatabase = QSqlDatabase::addDatabase("QSQLITE", "flysight");
-    mDatabase.setDatabaseName(path);
-
-    if (!mDatabase.open())
+    if (!mLogbook.open(path))
     {
-        QSqlError err = mDatabase.lastError();
-        QMessageBox::critical(0, tr("Failed to open database"), err.text());
-        return;
+        QMessageBox::critical(0, tr("Failed to open database"), mLogbook.lastError());
     }
-
-    if (!mDatabase.tables().contains("files"))
-    {
-        // Create table
-        QSqlQuery query(mDatabase);
-        if (!query.exec(QString("create table files ("
-                                    "id integer primary key, "
-                                    "file_name text, "
-                                    "description text, "
-                                    "start_time text, "
-                                    "duration integer, "
-                                    "sample_period integer, "
-                                    "min_lat integer, "
-                                    "max_lat integer, "
-                                    "min_lon integer, "
-                                    "max_lon integer, "
-                                    "import_time text)")))
-        {
-            QSqlError err = query.lastError();
-            QMessageBox::critical(0, tr("Query failed"), err.text());
-        }
-    }
-
-    // Add exit, ground and course
-    QSqlQuery query(mDatabase);
-    query.exec("alter table files add column exit text");
-    query.exec("alter table files add column ground real");
-    query.exec("alter table files add column course real");
-
-    // Add wind speed and direction
-    query.exec("alter table files add column wind_e real");
-    query.exec("alter table files add column wind_n real");
-
-    // Add zoom range
-    query.exec("alter table files add column t_min real");
-    query.exec("alter table files add column t_max real");
 }
 
 void MainWindow::initPlot()
@@ -302,6 +302,8 @@ void MainWindow::initPlot()
 
     connect(this, SIGNAL(dataChanged()),
             m_ui->plotArea, SLOT(updatePlot()));
+    connect(this, SIGNAL(optimalChanged()),
+            m_ui->plotArea, SLOT(updateOptimal()));
     connect(this, SIGNAL(rangeChanged()),
             m_ui->plotArea, SLOT(updateRange()));
     connect(this, SIGNAL(cursorChanged()),
@@ -414,6 +416,8 @@ void MainWindow::initScoringView()
 
     connect(this, SIGNAL(dataChanged()),
             mScoringView, SLOT(updateView()));
+    connect(this, SIGNAL(optimalChanged()),
+            mScoringView, SLOT(updateView()));
     connect(this, SIGNAL(rangeChanged()),
             mScoringView, SLOT(updateView()));
 }
@@ -516,6 +520,10 @@ void MainWindow::initLogbookView()
 void MainWindow::closeEvent(
         QCloseEvent *event)
 {
+    // Worker threads call into the scoring methods, which are deleted
+    // with this window
+    ScoringMethod::stopOptimizations();
+
     // Save window state
     writeSettings();
 
@@ -532,59 +540,19 @@ void MainWindow::closeEvent(
 DataPoint MainWindow::interpolateDataT(
         double t)
 {
-    const int i1 = findIndexBelowT(t);
-    const int i2 = findIndexAboveT(t);
-
-    if (i1 < 0)
-    {
-        return m_data.first();
-    }
-    else if (i2 >= m_data.size())
-    {
-        return m_data.last();
-    }
-    else
-    {
-        const DataPoint &dp1 = m_data[i1];
-        const DataPoint &dp2 = m_data[i2];
-        return DataPoint::interpolate(dp1, dp2, (t - dp1.t) / (dp2.t - dp1.t));
-    }
+    return TrackProcessor::interpolateDataT(m_data, t);
 }
 
 int MainWindow::findIndexBelowT(
         double t)
 {
-    int below = -1;
-    int above = m_data.size();
-
-    while (below + 1 != above)
-    {
-        int mid = (below + above) / 2;
-        const DataPoint &dp = m_data[mid];
-
-        if (dp.t < t) below = mid;
-        else          above = mid;
-    }
-
-    return below;
+    return TrackProcessor::findIndexBelowT(m_data, t);
 }
 
 int MainWindow::findIndexAboveT(
         double t)
 {
-    int below = -1;
-    int above = m_data.size();
-
-    while (below + 1 != above)
-    {
-        int mid = (below + above) / 2;
-        const DataPoint &dp = m_data[mid];
-
-        if (dp.t > t) above = mid;
-        else          below = mid;
-    }
-
-    return above;
+    return TrackProcessor::findIndexAboveT(m_data, t);
 }
 
 int MainWindow::findIndexForLanding()
@@ -614,11 +582,8 @@ void MainWindow::on_actionImport_triggered()
     // Sort files from oldest to newest
     qSort(fileNames);
 
-    // Import each file
-    foreach (QString fileName, fileNames)
-    {
-        importFile(fileName);
-    }
+    // Import files
+    importFiles(fileNames);
 }
 
 void MainWindow::on_actionImportFolder_triggered()
@@ -638,42 +603,165 @@ void MainWindow::on_actionImportFolder_triggered()
 
 void MainWindow::importFolder(
         QString folderName)
+{
+    QStringList fileNames;
+    findFiles(folderName, fileNames);
+
+    importFiles(fileNames);
+}
+
+void MainWindow::findFiles(
+        QString folderName,
+        QStringList &fileNames)
 {
     QDir dir(folderName);
 
-    // Import each file in this folder
+    // Add each file in this folder
     foreach (QString fileName, dir.entryList(QStringList() << "*.csv",
                                              QDir::Files,
                                              QDir::Name))
     {
-        importFile(dir.absoluteFilePath(fileName));
+        fileNames.append(dir.absoluteFilePath(fileName));
     }
 
     // Follow subfolders
     foreach (QString child, dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot,
                                           QDir::Name))
     {
-        importFolder(dir.absoluteFilePath(child));
+        findFiles(dir.absoluteFilePath(child), fileNames);
     }
 }
 
-void MainWindow::importFile(
-        QString fileName)
+void MainWindow::importFiles(
+        QStringList fileNames)
 {
+    if (fileNames.isEmpty()) return;
+
     // Initialize settings object
     QSettings settings("FlySight", "Viewer");
 
     // Remember last file read
-    settings.setValue("folder", QFileInfo(fileName).absoluteFilePath());
+    settings.setValue("folder", QFileInfo(fileNames.last()).absoluteFilePath());
 
-    // Create temporary file
-    QTemporaryFile temporaryFile;
-    if (!temporaryFile.open())
+    // Get tracks already in the database
+    QSet< QString > present;
+    if (!mLogbook.fileNames(present))
     {
-        QMessageBox::critical(0, tr("Import failed"), tr("Couldn't create temporary file"));
+        QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
         return;
     }
 
+    // New tracks have no database values, so these are the defaults
+    const TrackProcessor::Parameters params = trackParameters(QString());
+
+    // Hash, parse and summarize files in parallel
+    QProgressDialog progress(tr("Importing tracks..."), tr("Cancel"), 0, fileNames.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+
+    QFutureWatcher< ImportTask::Result > watcher;
+    connect(&watcher, SIGNAL(finished()), &progress, SLOT(reset()));
+    connect(&progress, SIGNAL(canceled()), &watcher, SLOT(cancel()));
+    connect(&watcher, SIGNAL(progressValueChanged(int)), &progress, SLOT(setValue(int)));
+
+    watcher.setFuture(QtConcurrent::mapped(fileNames, ImportTask(mProcessor, params, present)));
+
+    progress.exec();
+    watcher.waitForFinished();
+
+    const QFuture< ImportTask::Result > future = watcher.future();
+
+    // Add new tracks to the database in a single transaction
+    QDir(mDatabasePath).mkpath("FlySight/Tracks");
+
+    const qint64 importTime = QDateTime::currentMSecsSinceEpoch();
+
+    QString lastName;
+    QStringList failed;
+
+    mLogbook.transaction();
+
+    for (int i = 0; i < fileNames.size(); ++i)
+    {
+        // Skip files not reached before cancelling
+        if (!future.isResultReadyAt(i)) continue;
+
+        const ImportTask::Result result = future.resultAt(i);
+
+        if (!result.valid)
+        {
+            failed.append(QString("%1: %2").arg(result.fileName).arg(result.error));
+            continue;
+        }
+
+        lastName = result.uniqueName;
+
+        // Includes duplicates within this batch
+        if (present.contains(result.uniqueName)) continue;
+
+        QString newName = QString("FlySight/Tracks/%1.csv").arg(result.uniqueName);
+        QString newPath = QDir(mDatabasePath).filePath(newName);
+
+        if (!QFile::exists(newPath) && !QFile::copy(result.fileName, newPath))
+        {
+            failed.append(QString("%1: %2").arg(result.fileName).arg(tr("Couldn't copy file")));
+            continue;
+        }
+
+        if (!mLogbook.insertTrack(result.uniqueName,
+                                  QStringList()
+                                  << "description" << "start_time" << "duration"
+                                  << "sample_period" << "min_lat" << "max_lat"
+                                  << "min_lon" << "max_lon" << "import_time"
+                                  << "exit" << "ground" << "course"
+                                  << "wind_e" << "wind_n",
+                                  QVariantList()
+                                  << QString("") << dateTimeToUTC(result.startTime) << result.duration
+                                  << result.samplePeriod << result.minLat << result.maxLat
+                                  << result.minLon << result.maxLon << dateTimeToUTC(importTime)
+                                  << dateTimeToUTC(result.params.exit)
+                                  << QString::number(result.params.ground, 'f', 3)
+                                  << QString::number(result.params.course, 'f', 5)
+                                  << QString::number(result.params.windE, 'f', 2)
+                                  << QString::number(result.params.windN, 'f', 2)))
+        {
+            QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
+
+            mLogbook.rollback();
+            emit databaseChanged();
+            return;
+        }
+
+        present.insert(result.uniqueName);
+    }
+
+    if (!mLogbook.commit())
+    {
+        QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
+    }
+
+    emit databaseChanged();
+
+    if (!failed.isEmpty())
+    {
+        QMessageBox::critical(0, tr("Import failed"), failed.join("\n"));
+    }
+
+    // Show the last track imported
+    if (!lastName.isEmpty())
+    {
+        importFromDatabase(lastName);
+    }
+}
+
+void MainWindow::importFile(
+        QString fileName)
+{
+    // Initialize settings object
+    QSettings settings("FlySight", "Viewer");
+
+    // Remember last file read
+    settings.setValue("folder", QFileInfo(fileName).absoluteFilePath());
+
     QFile file(fileName);
     if (!file.open(QIODevice::ReadOnly))
     {
@@ -681,52 +769,44 @@ void MainWindow::importFile(
         return;
     }
 
-    // Copy to temporary file
-    temporaryFile.write(file.readAll());
-    file.close();
+    // Read the source once; it is hashed, parsed and stored from memory
+    const qint64 size = file.size();
+    uchar *map = size > 0 ? file.map(0, size) : 0;
+
+    QByteArray bytes;
+    if (!map) bytes = file.readAll();
+
+    const char *begin = map ? (const char *) map : bytes.constData();
+    const qint64 length = map ? size : bytes.size();
 
     // Get hash
     QCryptographicHash hash(QCryptographicHash::Md5);
-
-    temporaryFile.seek(0);
-    if (!hash.addData(&temporaryFile))
-    {
-        QMessageBox::critical(0, tr("Import failed"), tr("Couldn't generate hash"));
-        return;
-    }
+    hash.addData(begin, length);
 
     // Get name of file in database
     QString uniqueName = QString(hash.result().toHex());
     QString newName = QString("FlySight/Tracks/%1.csv").arg(uniqueName);
     QString newPath = QDir(mDatabasePath).filePath(newName);
 
-    QSqlQuery query(mDatabase);
-
     // Check if the file is in the database
-    if (!query.exec(QString("select * from files where file_name='%1'")
-                    .arg(uniqueName)))
+    bool isPresent;
+    if (!mLogbook.contains(uniqueName, isPresent))
     {
-        QSqlError err = query.lastError();
-        QMessageBox::critical(0, tr("Query failed"), err.text());
+        QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
         return;
     }
 
-    bool isPresent = query.next();
-
     // Add an empty record if the file is not in the database
     if (!isPresent)
     {
-        if (!query.exec(QString("insert into files (file_name) values ('%1')")
-                      .arg(uniqueName)))
+        if (!mLogbook.insertTrack(uniqueName))
         {
-            QSqlError err = query.lastError();
-            QMessageBox::critical(0, tr("Query failed"), err.text());
+            QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
         }
     }
 
     // Read file data
-    temporaryFile.seek(0);
-    import(&temporaryFile, m_data, uniqueName, true);
+    import(begin, length, m_data, uniqueName, true);
 
     // Clear optimum
     m_optimal.clear();
@@ -741,69 +821,41 @@ void MainWindow::importFile(
     {
         QDir(mDatabasePath).mkpath("FlySight/Tracks");
 
-        if (temporaryFile.copy(newPath))
+        // Store the content-addressed copy
+        QFile newFile(newPath);
+        if (newFile.open(QIODevice::WriteOnly)
+                && newFile.write(begin, length) == length)
         {
-            QDateTime startTime = m_data.front().dateTime;
-            qint64 duration = startTime.msecsTo(m_data.back().dateTime);
+            newFile.close();
 
-            int minLat = 900000000,  maxLat = -900000000;
-            int minLon = 1800000000, maxLon = -1800000000;
+            qint64 startTime, duration, samplePeriod;
+            int minLat, maxLat, minLon, maxLon;
 
-            QVector< double > dt;
-            for (int i = 0; i < m_data.size(); ++i)
-            {
-                if (i > 0)
-                {
-                    dt.push_back(m_data[i - 1].dateTime.msecsTo(m_data[i].dateTime));
-                }
+            ImportTask::summarize(m_data, startTime, duration, samplePeriod,
+                                  minLat, maxLat, minLon, maxLon);
 
-                int lat = m_data[i].lat * 10000000;
-                int lon = m_data[i].lon * 10000000;
+            qint64 importTime = QDateTime::currentMSecsSinceEpoch();
 
-                if (lat < minLat) minLat = lat;
-                if (lat > maxLat) maxLat = lat;
-                if (lon < minLon) minLon = lon;
-                if (lon > maxLon) maxLon = lon;
-            }
-            qSort(dt);
-            qint64 samplePeriod = dt[dt.size() / 2];
-
-            QDateTime importTime = QDateTime::currentDateTime();
-
-            if (!query.exec(QString("update files set "
-                                    "description='', "
-                                    "start_time='%1', "
-                                    "duration=%2, "
-                                    "sample_period=%3, "
-                                    "min_lat=%4, "
-                                    "max_lat=%5, "
-                                    "min_lon=%6, "
-                                    "max_lon=%7, "
-                                    "import_time='%8' "
-                                    "where file_name='%9'")
-                            .arg(dateTimeToUTC(startTime))
-                            .arg(duration)
-                            .arg(samplePeriod)
-                            .arg(minLat)
-                            .arg(maxLat)
-                            .arg(minLon)
-                            .arg(maxLon)
-                            .arg(dateTimeToUTC(importTime))
-                            .arg(uniqueName)))
-            {
-                QSqlError err = query.lastError();
-                QMessageBox::critical(0, tr("Query failed"), err.text());
-            }
+            setDatabaseValues(uniqueName,
+                              QStringList()
+                              << "description" << "start_time" << "duration"
+                              << "sample_period" << "min_lat" << "max_lat"
+                              << "min_lon" << "max_lon" << "import_time",
+                              QVariantList()
+                              << QString("") << dateTimeToUTC(startTime) << duration
+                              << samplePeriod << minLat << maxLat
+                              << minLon << maxLon << dateTimeToUTC(importTime));
         }
         else
         {
-            QMessageBox::critical(0, tr("Import failed"), tr("Couldn't copy temporary file"));
+            QMessageBox::critical(0, tr("Import failed"), tr("Couldn't copy file"));
         }
     }
 
-    // Delete temporary file
-    temporaryFile.close();
-    temporaryFile.remove();
+    if (map) file.unmap(map);
+
+    // Add the new record to views
+    if (!isPresent) emit databaseChanged();
 
     // Remember current track
     setTrackName(uniqueName);
@@ -812,19 +864,8 @@ void MainWindow::importFile(
 void MainWindow::importFromDatabase(
         const QString &uniqueName)
 {
-    // Get name of file in database
-    QString newName = QString("FlySight/Tracks/%1.csv").arg(uniqueName);
-    QString newPath = QDir(mDatabasePath).filePath(newName);
-
-    QFile file(newPath);
-    if (!file.open(QIODevice::ReadOnly))
-    {
-        QMessageBox::critical(0, tr("Import failed"), tr("Couldn't read file"));
-        return;
-    }
-
     // Read file data
-    import(&file, m_data, uniqueName, false);
+    if (!readTrack(uniqueName, m_data)) return;
 
     // Clear optimum
     m_optimal.clear();
@@ -841,8 +882,12 @@ void MainWindow::importFromDatabase(
 void MainWindow::setTrackName(
         const QString &trackName)
 {
+    const QString prevName = mTrackName;
     mTrackName = trackName;
-    emit databaseChanged();
+
+    // Move the current track marker
+    emit trackChanged(prevName);
+    emit trackChanged(mTrackName);
 }
 
 void MainWindow::setSelectedTracks(
@@ -856,30 +901,7 @@ void MainWindow::setTrackDescription(
         const QString &trackName,
         const QString &description)
 {
-    QSqlQuery query(mDatabase);
-
-    // Check the old description
-    if (!query.exec(QString("select * from files where (file_name='%1' and description='%2')")
-                    .arg(trackName).arg(description)))
-    {
-        QSqlError err = query.lastError();
-        QMessageBox::critical(0, tr("Query failed"), err.text());
-        return;
-    }
-
-    // Return now if description is not changed
-    if (query.next()) return;
-
-    // Change the decription
-    if (!query.exec(QString("update files set description='%1' where file_name='%2'")
-                    .arg(description).arg(trackName)))
-    {
-        QSqlError err = query.lastError();
-        QMessageBox::critical(0, tr("Query failed"), err.text());
-        return;
-    }
-
-    emit databaseChanged();
+    setDatabaseValue(trackName, "description", description);
 }
 
 void MainWindow::setTrackChecked(
@@ -896,19 +918,8 @@ void MainWindow::setTrackChecked(
         }
         else
         {
-            // Get name of file in database
-            QString newName = QString("FlySight/Tracks/%1.csv").arg(trackName);
-            QString newPath = QDir(mDatabasePath).filePath(newName);
-
-            QFile file(newPath);
-            if (!file.open(QIODevice::ReadOnly))
-            {
-                QMessageBox::critical(0, tr("Import failed"), tr("Couldn't read file"));
-                return;
-            }
-
             // Read file data
-            import(&file, data, trackName, false);
+            if (!readTrack(trackName, data)) return;
         }
 
         mCheckedTracks.insert(trackName, data);
@@ -921,6 +932,57 @@ void MainWindow::setTrackChecked(
     emit dataChanged();
 }
 
+QMap< QString, MainWindow::DataPoints > MainWindow::optimizationTracks()
+{
+    if (!mCheckedTracks.isEmpty()) return mCheckedTracks;
+
+    QMap< QString, DataPoints > tracks;
+    foreach (const QString &trackName, mSelectedTracks)
+    {
+        DataPoints data;
+        if (trackName == mTrackName)
+        {
+            data = m_data;
+        }
+        else if (!readTrack(trackName, data))
+        {
+            continue;
+        }
+
+        tracks.insert(trackName, data);
+    }
+
+    return tracks;
+}
+
+bool MainWindow::saveOptimal(
+        const QString &trackName,
+        ScoringMode mode,
+        double actualScore,
+        double optimalScore,
+        const DataPoints &result)
+{
+    // Only the values the simulation produces
+    QByteArray trajectory;
+    QDataStream stream(&trajectory, QIODevice::WriteOnly);
+    stream << (quint32) result.size();
+    foreach (const DataPoint &dp, result)
+    {
+        stream << dp.t << dp.x << dp.z << dp.hMSL
+               << dp.vy << dp.velD
+               << dp.dist2D << dp.dist3D
+               << dp.lift << dp.drag;
+    }
+
+    if (!mLogbook.setOptimal(trackName, mode, actualScore, optimalScore, trajectory))
+    {
+        QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
+        return false;
+    }
+
+    return true;
+}
+
 bool MainWindow::trackChecked(
         const QString &trackName) const
 {
@@ -945,520 +1007,178 @@ void MainWindow::importFromCheckedTrack(
     setTrackName(uniqueName);
 }
 
-void MainWindow::import(
-        QIODevice *device,
-        DataPoints &data,
-        QString trackName,
-        bool initDatabase)
+bool MainWindow::readTrack(
+        const QString &uniqueName,
+        DataPoints &data)
 {
-    QTextStream in(device);
-
-    // Column enumeration
-    typedef enum {
-        Time = 0,
-        Lat,
-        Lon,
-        HMSL,
-        VelN,
-        VelE,
-        VelD,
-        HAcc,
-        VAcc,
-        SAcc,
-        Heading,
-        CAcc,
-        NumSV
-    } Columns;
-
-    // Read column labels
-    QMap< int, int > colMap;
-    if (!in.atEnd())
-    {
-        QString line = in.readLine();
-        QStringList cols = line.split(",");
-
-        for (int i = 0; i < cols.size(); ++i)
-        {
-            const QString &s = cols[i];
-
-            if (s == "time")    colMap[Time]    = i;
-            if (s == "lat")     colMap[Lat]     = i;
-            if (s == "lon")     colMap[Lon]     = i;
-            if (s == "hMSL")    colMap[HMSL]    = i;
-            if (s == "velN")    colMap[VelN]    = i;
-            if (s == "velE")    colMap[VelE]    = i;
-            if (s == "velD")    colMap[VelD]    = i;
-            if (s == "hAcc")    colMap[HAcc]    = i;
-            if (s == "vAcc")    colMap[VAcc]    = i;
-            if (s == "sAcc")    colMap[SAcc]    = i;
-            if (s == "numSV")   colMap[NumSV]   = i;
-        }
-    }
+    const TrackProcessor::Parameters params = trackParameters(uniqueName);
 
-    // Skip next row
-    if (!in.atEnd()) in.readLine();
-
-    data.clear();
-
-    while (!in.atEnd())
+    // Use the processed copy if it is still valid
+    if (TrackCache::read(cachePath(uniqueName), params, mProcessor.halfWidth(), data))
     {
-        QString line = in.readLine();
-        QStringList cols = line.split(",");
-
-        DataPoint pt;
-
-        pt.dateTime = QDateTime::fromString(cols[colMap[Time]], Qt::ISODate);
-
-        pt.hasGeodetic = true;
-
-        pt.lat   = cols[colMap[Lat]].toDouble();
-        pt.lon   = cols[colMap[Lon]].toDouble();
-        pt.hMSL  = cols[colMap[HMSL]].toDouble();
-
-        pt.velN  = cols[colMap[VelN]].toDouble();
-        pt.velE  = cols[colMap[VelE]].toDouble();
-        pt.velD  = cols[colMap[VelD]].toDouble();
-
-        pt.hAcc  = cols[colMap[HAcc]].toDouble();
-        pt.vAcc  = cols[colMap[VAcc]].toDouble();
-        pt.sAcc  = cols[colMap[SAcc]].toDouble();
-
-        pt.numSV = cols[colMap[NumSV]].toDouble();
-
-        data.append(pt);
+        return true;
     }
 
-    // Initialize time
-    initTime(data);
+    // Get name of file in database
+    QString newName = QString("FlySight/Tracks/%1.csv").arg(uniqueName);
+    QString newPath = QDir(mDatabasePath).filePath(newName);
 
-    // Altitude above ground
-    initAltitude(data, trackName, initDatabase);
+    QFile file(newPath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        QMessageBox::critical(0, tr("Import failed"), tr("Couldn't read file"));
+        return false;
+    }
 
-    // Raw acceleration
-    initAcceleration(data);
+    import(&file, data, uniqueName, false);
 
-    // Pick exit
-    initExit(data, trackName, initDatabase);
+    // Update cache for next time
+    QDir(mDatabasePath).mkpath("FlySight/Cache");
+    TrackCache::write(cachePath(uniqueName), params, mProcessor.halfWidth(), data);
 
-    // Wind adjustments
-    updateVelocity(data, trackName, initDatabase);
+    return true;
 }
 
-void MainWindow::initTime(
-        DataPoints &data)
+QString MainWindow::cachePath(
+        const QString &uniqueName) const
 {
-    const DataPoint &dp0 = data[0];
-    qint64 start = dp0.dateTime.toMSecsSinceEpoch();
-
-    for (int i = 0; i < data.size(); ++i)
-    {
-        DataPoint &dp = data[i];
-        qint64 end = dp.dateTime.toMSecsSinceEpoch();
-        dp.t = (double) (end - start) / 1000;
-    }
+    QString cacheName = QString("FlySight/Cache/%1.bin").arg(uniqueName);
+    return QDir(mDatabasePath).filePath(cacheName);
 }
 
-void MainWindow::initExit(
+void MainWindow::import(
+        QFile *file,
         DataPoints &data,
         QString trackName,
         bool initDatabase)
 {
-    QString value;
-    qint64 start;
-    if (getDatabaseValue(trackName, "exit", value))
-    {
-        start = QDateTime::fromString(value, Qt::ISODate)
-                .toMSecsSinceEpoch();
-    }
-    else
-    {
-        bool foundExit = false;
+    // Parse directly from a mapping of the file if possible
+    file->flush();
 
-        for (int i = 1; i < data.size() && !foundExit; ++i)
-        {
-            const DataPoint &dp1 = data[i - 1];
-            const DataPoint &dp2 = data[i];
-
-            // Get interpolation coefficient
-            const double velD = A_GRAVITY;
-            const double a = (velD - dp1.velD) / (dp2.velD - dp1.velD);
-
-            // Check vertical speed
-            if (a < 0 || 1 < a) continue;
+    const qint64 size = file->size();
+    uchar *map = size > 0 ? file->map(0, size) : 0;
 
-            // Check accuracy
-            const double vAcc = dp1.vAcc + a * (dp2.vAcc - dp1.vAcc);
-            if (vAcc > 10) continue;
-
-            // Check acceleration
-            const double az = dp1.az + a * (dp2.az - dp1.az);
-            if (az < A_GRAVITY / 5.) continue;
-
-            // Determine exit
-            const qint64 t1 = dp1.dateTime.toMSecsSinceEpoch();
-            const qint64 t2 = dp2.dateTime.toMSecsSinceEpoch();
-            start = t1 + a * (t2 - t1) - velD / az * 1000.;
-            foundExit = true;
-        }
-
-        if (!foundExit)
-        {
-            const DataPoint &dp0 = data[0];
-            start = dp0.dateTime.toMSecsSinceEpoch();
-        }
-    }
-
-    if (initDatabase)
+    if (map)
     {
-        QDateTime dt = QDateTime::fromMSecsSinceEpoch(start, Qt::UTC);
-        setDatabaseValue(trackName, "exit", dateTimeToUTC(dt));
+        import((const char *) map, size, data, trackName, initDatabase);
+        file->unmap(map);
     }
-
-    for (int i = 0; i < data.size(); ++i)
+    else
     {
-        DataPoint &dp = data[i];
-        qint64 end = dp.dateTime.toMSecsSinceEpoch();
-        dp.t = (double) (end - start) / 1000;
+        file->seek(0);
+        const QByteArray bytes = file->readAll();
+
+        import(bytes.constData(), bytes.size(), data, trackName, initDatabase);
     }
 }
 
-void MainWindow::initAltitude(
+void MainWindow::import(
+        const char *buffer,
+        qint64 size,
         DataPoints &data,
         QString trackName,
         bool initDatabase)
 {
-    QString value;
-    double ground;
-    if (getDatabaseValue(trackName, "ground", value))
-    {
-        ground = value.toDouble();
-    }
-    else if (mGroundReference == Automatic)
-    {
-        const DataPoint &dp0 = data[data.size() - 1];
-        ground = dp0.hMSL;
-    }
-    else
-    {
-        ground = mFixedReference;
-    }
+    FlySightReader reader(buffer, size);
+    reader.read(data);
 
-    if (initDatabase)
-    {
-        setDatabaseValue(trackName, "ground", QString::number(ground, 'f', 3));
-    }
+    // Return now if there is no data
+    if (data.isEmpty()) return;
 
-    for (int i = 0; i < data.size(); ++i)
-    {
-        DataPoint &dp = data[i];
-        dp.z = dp.hMSL - ground;
-    }
-}
+    // Derive all quantities from the raw samples
+    TrackProcessor::Parameters params = trackParameters(trackName);
+    mProcessor.process(data, params);
 
-void MainWindow::initAcceleration(
-        DataPoints &data)
-{
-    for (int i = 0; i < data.size(); ++i)
+    if (initDatabase)
     {
-        DataPoint &dp = data[i];
-
-        // Acceleration
-        double accelN = getSlope(i, DataPoint::northSpeedRaw);
-        double accelE = getSlope(i, DataPoint::eastSpeedRaw);
-        double accelD = getSlope(i, DataPoint::verticalSpeed);
-
-        // Calculate acceleration in direction of flight
-        const double vh = sqrt(dp.velN * dp.velN + dp.velE * dp.velE);
-        dp.ax = (accelN * dp.velN + accelE * dp.velE) / vh;
-
-        // Calculate acceleration perpendicular to flight
-        dp.ay = (accelE * dp.velN - accelN * dp.velE) / vh;
-
-        // Calculate vertical acceleration
-        dp.az = accelD;
-
-        // Calculate total acceleration
-        dp.amag = sqrt(accelN * accelN + accelE * accelE + accelD * accelD);
+        setDatabaseValues(trackName,
+                          QStringList() << "ground" << "exit" << "wind_e" << "wind_n" << "course",
+                          QVariantList() << QString::number(params.ground, 'f', 3)
+                                         << dateTimeToUTC(params.exit)
+                                         << QString::number(params.windE, 'f', 2)
+                                         << QString::number(params.windN, 'f', 2)
+                                         << QString::number(params.course, 'f', 5));
     }
 }
 
-void MainWindow::updateVelocity(
-        DataPoints &data,
-        QString trackName,
-        bool initDatabase)
+TrackProcessor::Parameters MainWindow::trackParameters(
+        QString trackName)
 {
-    double windE, windN;
-    getWind(trackName, &windE, &windN);
+    TrackProcessor::Parameters params;
+    QString value;
 
-    if (initDatabase)
+    if (getDatabaseValue(trackName, "ground", value))
     {
-        setDatabaseValue(trackName, "wind_e", QString::number(windE, 'f', 2));
-        setDatabaseValue(trackName, "wind_n", QString::number(windN, 'f', 2));
+        params.hasGround = true;
+        params.ground = value.toDouble();
     }
-
-    if (mWindAdjustment)
+    else if (mGroundReference == Automatic)
     {
-        // Wind-adjusted position
-        for (int i = 0; i < data.size(); ++i)
-        {
-            const DataPoint &dp0 = interpolateDataT(0);
-            DataPoint &dp = data[i];
-
-            double distance = getDistance(dp0, dp);
-            double bearing = getBearing(dp0, dp);
-
-            dp.x = distance * sin(bearing) - windE * dp.t;
-            dp.y = distance * cos(bearing) - windN * dp.t;
-        }
-
-        // Wind-adjusted velocity
-        for (int i = 0; i < data.size(); ++i)
-        {
-            DataPoint &dp = data[i];
-
-            dp.vx = dp.velE - windE;
-            dp.vy = dp.velN - windN;
-        }
+        params.hasGround = false;
+        params.ground = 0;
     }
     else
     {
-        // Unadjusted position
-        for (int i = 0; i < data.size(); ++i)
-        {
-            const DataPoint &dp0 = interpolateDataT(0);
-            DataPoint &dp = data[i];
-
-            double distance = getDistance(dp0, dp);
-            double bearing = getBearing(dp0, dp);
-
-            dp.x = distance * sin(bearing);
-            dp.y = distance * cos(bearing);
-        }
-
-        // Unadjusted velocity
-        for (int i = 0; i < data.size(); ++i)
-        {
-            DataPoint &dp = data[i];
-
-            dp.vx = dp.velE;
-            dp.vy = dp.velN;
-        }
+        params.hasGround = true;
+        params.ground = mFixedReference;
     }
 
-    // Distance measurements
-    double dist2D = 0, dist3D = 0;
-
-    for (int i = 0; i < data.size(); ++i)
+    if (getDatabaseValue(trackName, "exit", value))
     {
-        DataPoint &dp = data[i];
-
-        if (i > 0)
-        {
-            const DataPoint &dpPrev = data[i - 1];
-
-            double dx = dp.x - dpPrev.x;
-            double dy = dp.y - dpPrev.y;
-            double dh = sqrt(dx * dx + dy * dy);
-            double dz = dp.hMSL - dpPrev.hMSL;
-
-            dist2D += dh;
-            dist3D += sqrt(dh * dh + dz * dz);
-        }
-
-        dp.dist2D = dist2D;
-        dp.dist3D = dist3D;
+        params.hasExit = true;
+        params.exit = QDateTime::fromString(value, Qt::ISODate)
+                .toMSecsSinceEpoch();
     }
-
-    // Adjust for exit
-    DataPoint dp0 = interpolateDataT(0);
-
-    for (int i = 0; i < data.size(); ++i)
+    else
     {
-        DataPoint &dp = data[i];
-
-        dp.x -= dp0.x;
-        dp.y -= dp0.y;
-
-        dp.dist2D -= dp0.dist2D;
-        dp.dist3D -= dp0.dist3D;
+        params.hasExit = false;
+        params.exit = 0;
     }
 
-    QString value;
-    double theta0;
+    getWind(trackName, &params.windE, &params.windN);
+    params.windAdjustment = mWindAdjustment;
+
     if (getDatabaseValue(trackName, "course", value))
     {
-        theta0 = value.toDouble();
+        params.course = value.toDouble();
     }
     else
     {
-        theta0 = 0;
-    }
-
-    if (initDatabase)
-    {
-        setDatabaseValue(trackName, "course", QString::number(theta0, 'f', 5));
-    }
-
-    // Cumulative heading
-    double prevHeading;
-    bool firstHeading = true;
-
-    for (int i = 0; i < data.size(); ++i)
-    {
-        DataPoint &dp = data[i];
-
-        // Calculate heading
-        dp.heading = atan2(dp.vx, dp.vy) / PI * 180;
-
-        // Calculate heading accuracy
-        const double s = DataPoint::totalSpeed(dp);
-        if (s != 0) dp.cAcc = dp.sAcc / s;
-        else        dp.cAcc = 0;
-
-        // Adjust heading
-        if (!firstHeading)
-        {
-            while (dp.heading <  prevHeading - 180) dp.heading += 360;
-            while (dp.heading >= prevHeading + 180) dp.heading -= 360;
-        }
-
-        // Relative heading
-        dp.theta = dp.heading - theta0;
-
-        firstHeading = false;
-        prevHeading = dp.heading;
+        params.course = 0;
     }
 
-    // Parameters depending on velocity
-    for (int i = 0; i < data.size(); ++i)
-    {
-        DataPoint &dp = data[i];
-
-        dp.curv = getSlope(i, DataPoint::diveAngle);
-        dp.accel = getSlope(i, DataPoint::totalSpeed);
-        dp.omega = getSlope(i, DataPoint::course);
-    }
+    params.mass = m_mass;
+    params.planformArea = m_planformArea;
 
-    // Initialize aerodynamics
-    initAerodynamics(data);
+    return params;
 }
 
-void MainWindow::initAerodynamics(
-        DataPoints &data)
+void MainWindow::updateVelocity(
+        DataPoints &data,
+        QString trackName)
 {
-    for (int i = 0; i < data.size(); ++i)
-    {
-        DataPoint &dp = data[i];
-
-        // Acceleration
-        double accelN = getSlope(i, DataPoint::northSpeed);
-        double accelE = getSlope(i, DataPoint::eastSpeed);
-        double accelD = getSlope(i, DataPoint::verticalSpeed);
-
-        // Subtract acceleration due to gravity
-        accelD -= A_GRAVITY;
-
-        // Calculate acceleration due to drag
-        const double vel = DataPoint::totalSpeed(dp);
-        const double proj = (accelN * dp.vy + accelE * dp.vx + accelD * dp.velD) / vel;
-
-        const double dragN = proj * dp.vy / vel;
-        const double dragE = proj * dp.vx / vel;
-        const double dragD = proj * dp.velD / vel;
-
-        const double accelDrag = sqrt(dragN * dragN + dragE * dragE + dragD * dragD);
-
-        // Calculate acceleration due to lift
-        const double liftN = accelN - dragN;
-        const double liftE = accelE - dragE;
-        const double liftD = accelD - dragD;
-
-        const double accelLift = sqrt(liftN * liftN + liftE * liftE + liftD * liftD);
-
-        // From https://en.wikipedia.org/wiki/Atmospheric_pressure#Altitude_variation
-        const double airPressure = SL_PRESSURE * pow(1 - LAPSE_RATE * dp.hMSL / SL_TEMP, A_GRAVITY * MM_AIR / GAS_CONST / LAPSE_RATE);
-
-        // From https://en.wikipedia.org/wiki/Lapse_rate
-        const double temperature = SL_TEMP - LAPSE_RATE * dp.hMSL;
-
-        // From https://en.wikipedia.org/wiki/Density_of_air
-        const double airDensity = airPressure / (GAS_CONST / MM_AIR) / temperature;
-
-        // From https://en.wikipedia.org/wiki/Dynamic_pressure
-        const double dynamicPressure = airDensity * vel * vel / 2;
-
-        // Calculate lift and drag coefficients
-        dp.lift = m_mass * accelLift / dynamicPressure / m_planformArea;
-        dp.drag = m_mass * accelDrag / dynamicPressure / m_planformArea;
-    }
+    mProcessor.updateVelocity(data, trackParameters(trackName));
 }
 
-double MainWindow::getSlope(
-        const int center,
-        double (*value)(const DataPoint &)) const
+void MainWindow::updateAerodynamics(
+        DataPoints &data,
+        QString trackName)
 {
-    int iMin = qMax (0, center - 4);
-    int iMax = qMin (m_data.size () - 1, center + 4);
-
-    double sumx = 0, sumy = 0, sumxx = 0, sumxy = 0;
-
-    for (int i = iMin; i <= iMax; ++i)
-    {
-        const DataPoint &dp = m_data[i];
-        double y = value(dp);
-
-        sumx += dp.t;
-        sumy += y;
-        sumxx += dp.t * dp.t;
-        sumxy += dp.t * y;
-    }
-
-    int n = iMax - iMin + 1;
-    return (sumxy - sumx * sumy / n) / (sumxx - sumx * sumx / n);
+    mProcessor.updateAerodynamics(data, trackParameters(trackName));
 }
 
 double MainWindow::getDistance(
         const DataPoint &dp1,
         const DataPoint &dp2)
 {
-    if (!mWindAdjustment && dp1.hasGeodetic && dp2.hasGeodetic)
-    {
-        const Geodesic &geod = Geodesic::WGS84();
-        double s12;
-
-        geod.Inverse(dp1.lat, dp1.lon, dp2.lat, dp2.lon, s12);
-
-        return s12;
-    }
-    else
-    {
-        const double dx = dp2.x - dp1.x;
-        const double dy = dp2.y - dp1.y;
-
-        return sqrt(dx * dx + dy * dy);
-    }
+    return TrackProcessor::getDistance(dp1, dp2, mWindAdjustment);
 }
 
 double MainWindow::getBearing(
         const DataPoint &dp1,
         const DataPoint &dp2)
 {
-    if (!mWindAdjustment && dp1.hasGeodetic && dp2.hasGeodetic)
-    {
-        const Geodesic &geod = Geodesic::WGS84();
-        double azi1, azi2;
-
-        geod.Inverse(dp1.lat, dp1.lon, dp2.lat, dp2.lon, azi1, azi2);
-
-        return azi1 / 180 * PI;
-    }
-    else
-    {
-        const double dx = dp2.x - dp1.x;
-        const double dy = dp2.y - dp1.y;
-
-        return atan2(dx, dy);
-    }
+    return TrackProcessor::getBearing(dp1, dp2, mWindAdjustment);
 }
 
 void MainWindow::setMark(
@@ -1522,10 +1242,10 @@ void MainWindow::initRange(
             && getDatabaseValue(trackName, "t_max", strMax))
     {
         const DataPoint &dp0 = m_data[0];
-        mZoomLevel.rangeLower = dp0.t + dp0.dateTime.msecsTo(
-                    QDateTime::fromString(strMin, Qt::ISODate)) / 1000.;
-        mZoomLevel.rangeUpper = dp0.t + dp0.dateTime.msecsTo(
-                    QDateTime::fromString(strMax, Qt::ISODate)) / 1000.;
+        const qint64 tMin = QDateTime::fromString(strMin, Qt::ISODate).toMSecsSinceEpoch();
+        const qint64 tMax = QDateTime::fromString(strMax, Qt::ISODate).toMSecsSinceEpoch();
+        mZoomLevel.rangeLower = dp0.t + (tMin - dp0.timestamp) / 1000.;
+        mZoomLevel.rangeUpper = dp0.t + (tMax - dp0.timestamp) / 1000.;
     }
     else if (!m_data.isEmpty())
     {
@@ -1766,7 +1486,7 @@ void MainWindow::on_actionWind_triggered()
     m_ui->actionWind->setChecked(mWindAdjustment);
 
     // Update plot data
-    updateVelocity(m_data, mTrackName, false);
+    updateVelocity(m_data, mTrackName);
 
     // Update checked tracks
     QMap< QString, DataPoints >::iterator p;
@@ -1774,7 +1494,7 @@ void MainWindow::on_actionWind_triggered()
          p != mCheckedTracks.end();
          ++p)
     {
-        updateVelocity(p.value(), p.key(), false);
+        updateVelocity(p.value(), p.key());
     }
 
     emit dataChanged();
@@ -1879,12 +1599,15 @@ void MainWindow::on_actionPreferences_triggered()
             m_planformArea = dlg.planformArea();
 
             // Update plot data
-            initAerodynamics(m_data);
+            updateAerodynamics(m_data, mTrackName);
 
             // Update checked tracks
-            foreach (DataPoints data, mCheckedTracks)
+            QMap< QString, DataPoints >::iterator p;
+            for (p = mCheckedTracks.begin();
+                 p != mCheckedTracks.end();
+                 ++p)
             {
-                initAerodynamics(data);
+                updateAerodynamics(p.value(), p.key());
             }
 
             emit dataChanged();
@@ -2137,17 +1860,26 @@ void MainWindow::on_actionExportPlot_triggered()
         double lower = rangeLower();
         double upper = rangeUpper();
 
+        // Read columns from the cache rather than evaluating each sample
+        const QVector< double > &x = plotValues(m_ui->plotArea->xValue());
+
+        QVector< const QVector< double >* > y;
+        for (int j = 0; j < DataPlot::yaLast; ++j)
+        {
+            if (!m_ui->plotArea->yValue(j)->visible()) continue;
+            y.append(&plotValues(m_ui->plotArea->yValue(j)));
+        }
+
         for (int i = 0; i < dataSize(); ++i)
         {
             const DataPoint &dp = dataPoint(i);
 
             if (lower <= dp.t && dp.t <= upper)
             {
-                stream << m_ui->plotArea->xValue()->value(dp, m_units);
-                for (int j = 0; j < DataPlot::yaLast; ++j)
+                stream << x[i];
+                for (int j = 0; j < y.size(); ++j)
                 {
-                    if (!m_ui->plotArea->yValue(j)->visible()) continue;
-                    stream << QString(",%1").arg(m_ui->plotArea->yValue(j)->value(dp, m_units), 0, 'f');
+                    stream << QString(",%1").arg((*y[j])[i], 0, 'f');
                 }
                 stream << endl;
             }
@@ -2196,7 +1928,7 @@ void MainWindow::on_actionExportTrack_triggered()
 
             if (lower <= dp.t && dp.t <= upper)
             {
-                stream << dateTimeToUTC(dp.dateTime) << ",";
+                stream << dateTimeToUTC(dp.timestamp) << ",";
 
                 stream << QString::number(dp.lat, 'f', 7) << ",";
                 stream << QString::number(dp.lon, 'f', 7) << ",";
@@ -2227,8 +1959,10 @@ void MainWindow::on_actionExportTrack_triggered()
 }
 
 QString MainWindow::dateTimeToUTC(
-        const QDateTime &dt)
+        qint64 msecs)
 {
+    const QDateTime dt = QDateTime::fromMSecsSinceEpoch(msecs, Qt::UTC);
+
     QString ret;
     ret += dt.toUTC().date().toString(Qt::ISODate) + "T";
     ret += dt.toUTC().time().toString(Qt::ISODate) + ".";
@@ -2288,7 +2022,7 @@ void MainWindow::setZero(
     if (m_data.isEmpty()) return;
 
     DataPoint dp0 = interpolateDataT(t);
-    setDatabaseValue(mTrackName, "exit", dateTimeToUTC(dp0.dateTime));
+    setDatabaseValue(mTrackName, "exit", dateTimeToUTC(dp0.timestamp));
 
     for (int i = 0; i < m_data.size(); ++i)
     {
@@ -2345,7 +2079,7 @@ void MainWindow::setTrackGround(
     // Update current track
     if (trackName == mTrackName)
     {
-        updateGround(m_data, ground);
+        TrackProcessor::updateGround(m_data, ground);
         emit dataChanged();
     }
 
@@ -2357,7 +2091,7 @@ void MainWindow::setTrackGround(
     {
         if (trackName == p.key())
         {
-            updateGround(p.value(), ground);
+            TrackProcessor::updateGround(p.value(), ground);
         }
     }
 }
@@ -2373,13 +2107,15 @@ void MainWindow::setTrackWindSpeed(
     windE = -windSpeed * sin(windDir / 180 * PI);
     windN = -windSpeed * cos(windDir / 180 * PI);
 
-    setDatabaseValue(trackName, "wind_e", QString::number(windE, 'f', 2));
-    setDatabaseValue(trackName, "wind_n", QString::number(windN, 'f', 2));
+    setDatabaseValues(trackName,
+                      QStringList() << "wind_e" << "wind_n",
+                      QVariantList() << QString::number(windE, 'f', 2)
+                                     << QString::number(windN, 'f', 2));
 
     // Update current track
     if (trackName == mTrackName)
     {
-        updateVelocity(m_data, mTrackName, false);
+        updateVelocity(m_data, mTrackName);
         emit dataChanged();
     }
 
@@ -2391,7 +2127,7 @@ void MainWindow::setTrackWindSpeed(
     {
         if (trackName == p.key())
         {
-            updateVelocity(p.value(), p.key(), false);
+            updateVelocity(p.value(), p.key());
         }
     }
 }
@@ -2407,13 +2143,15 @@ void MainWindow::setTrackWindDir(
     windE = -windSpeed * sin(windDir / 180 * PI);
     windN = -windSpeed * cos(windDir / 180 * PI);
 
-    setDatabaseValue(trackName, "wind_e", QString::number(windE, 'f', 2));
-    setDatabaseValue(trackName, "wind_n", QString::number(windN, 'f', 2));
+    setDatabaseValues(trackName,
+                      QStringList() << "wind_e" << "wind_n",
+                      QVariantList() << QString::number(windE, 'f', 2)
+                                     << QString::number(windN, 'f', 2));
 
     // Update current track
     if (trackName == mTrackName)
     {
-        updateVelocity(m_data, mTrackName, false);
+        updateVelocity(m_data, mTrackName);
         emit dataChanged();
     }
 
@@ -2425,22 +2163,11 @@ void MainWindow::setTrackWindDir(
     {
         if (trackName == p.key())
         {
-            updateVelocity(p.value(), p.key(), false);
+            updateVelocity(p.value(), p.key());
         }
     }
 }
 
-void MainWindow::updateGround(
-        DataPoints &data,
-        double ground)
-{
-    for (int i = 0; i < data.size(); ++i)
-    {
-        DataPoint &dp = data[i];
-        dp.z = dp.hMSL - ground;
-    }
-}
-
 void MainWindow::setCourse(
         double t)
 {
@@ -2465,30 +2192,30 @@ bool MainWindow::setDatabaseValue(
         QString column,
         QString value)
 {
-    QSqlQuery query(mDatabase);
-
-    // Check the old value
-    if (!query.exec(QString("select * from files where (file_name='%1' and %2='%3')")
-                    .arg(trackName).arg(column).arg(value)))
+    bool changed = false;
+    if (!mLogbook.setValue(trackName, column, value, changed))
     {
-        QSqlError err = query.lastError();
-        QMessageBox::critical(0, tr("Query failed"), err.text());
+        QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
         return false;
     }
 
-    // Return now if value is not changed
-    if (query.next()) return true;
+    if (changed) emit trackChanged(trackName);
+    return true;
+}
 
-    // Change the value
-    if (!query.exec(QString("update files set %1='%2' where file_name='%3'")
-                    .arg(column).arg(value).arg(trackName)))
+bool MainWindow::setDatabaseValues(
+        QString trackName,
+        QStringList columns,
+        QVariantList values)
+{
+    bool changed = false;
+    if (!mLogbook.setValues(trackName, columns, values, changed))
     {
-        QSqlError err = query.lastError();
-        QMessageBox::critical(0, tr("Query failed"), err.text());
+        QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
         return false;
     }
 
-    emit databaseChanged();
+    if (changed) emit trackChanged(trackName);
     return true;
 }
 
@@ -2497,25 +2224,18 @@ bool MainWindow::getDatabaseValue(
         QString column,
         QString &value)
 {
-    QSqlQuery query(mDatabase);
-
-    // Read value from database
-    if (!query.exec(QString("select %1 from files where file_name='%2'")
-                    .arg(column).arg(trackName)))
+    QVariant result;
+    if (!mLogbook.value(trackName, column, result))
     {
-        QSqlError err = query.lastError();
-        QMessageBox::critical(0, tr("Query failed"), err.text());
+        QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
         return false;
     }
 
-    // Check if there is a result
-    if (!query.next()) return false;
-
-    // Handle empty results
-    if (query.value(0).toString().isEmpty()) return false;
+    // Handle missing and empty results
+    if (result.toString().isEmpty()) return false;
 
     // Return the result
-    value = query.value(0).toString();
+    value = result.toString();
     return true;
 }
 
@@ -2590,11 +2310,13 @@ void MainWindow::setWind(
         double windE,
         double windN)
 {
-    setDatabaseValue(mTrackName, "wind_e", QString::number(windE, 'f', 2));
-    setDatabaseValue(mTrackName, "wind_n", QString::number(windN, 'f', 2));
+    setDatabaseValues(mTrackName,
+                      QStringList() << "wind_e" << "wind_n",
+                      QVariantList() << QString::number(windE, 'f', 2)
+                                     << QString::number(windN, 'f', 2));
 
     // Update plot data
-    updateVelocity(m_data, mTrackName, false);
+    updateVelocity(m_data, mTrackName);
 
     // Update checked tracks
     QMap< QString, DataPoints >::iterator p;
@@ -2602,7 +2324,7 @@ void MainWindow::setWind(
          p != mCheckedTracks.end();
          ++p)
     {
-        updateVelocity(p.value(), p.key(), false);
+        updateVelocity(p.value(), p.key());
     }
 
     emit dataChanged();
@@ -2672,12 +2394,13 @@ void MainWindow::on_actionRedoZoom_triggered()
 
 void MainWindow::saveZoomToDatabase()
 {
-    DataPoint dp = interpolateDataT(mZoomLevel.rangeLower);
-    setDatabaseValue(mTrackName, "t_min", dateTimeToUTC(dp.dateTime));
-    dp = interpolateDataT(mZoomLevel.rangeUpper);
-    setDatabaseValue(mTrackName, "t_max", dateTimeToUTC(dp.dateTime));
+    DataPoint dpLower = interpolateDataT(mZoomLevel.rangeLower);
+    DataPoint dpUpper = interpolateDataT(mZoomLevel.rangeUpper);
 
-    emit databaseChanged();
+    setDatabaseValues(mTrackName,
+                      QStringList() << "t_min" << "t_max",
+                      QVariantList() << dateTimeToUTC(dpLower.timestamp)
+                                     << dateTimeToUTC(dpUpper.timestamp));
 }
 
 void MainWindow::on_actionZoomToExtent_triggered()
@@ -2728,12 +2451,13 @@ void MainWindow::on_actionDeleteTrack_triggered()
             QMessageBox::critical(0, tr("Operation failed"), tr("Couldn't delete track"));
         }
 
+        // Delete cached copy if there is one
+        QFile::remove(cachePath(uniqueName));
+
         // Remove track from database
-        QSqlQuery query(mDatabase);
-        if (!query.exec(QString("delete from files where file_name='%1'").arg(uniqueName)))
+        if (!mLogbook.removeTrack(uniqueName))
         {
-            QSqlError err = query.lastError();
-            QMessageBox::critical(0, tr("Query failed"), err.text());
+            QMessageBox::critical(0, tr("Query failed"), mLogbook.lastError());
         }
     }
 
@@ -2758,10 +2482,24 @@ void MainWindow::on_actionChangeUnits_triggered()
 void MainWindow::setScoringMode(
         ScoringMode mode)
 {
-    mScoringMode = mode;
+    if (mode != mScoringMode)
+    {
+        mScoringMode = mode;
+        emit scoringModeChanged();
+    }
+
     emit dataChanged();
 }
 
+void MainWindow::setOptimizationEngine(
+        OptimizationEngine engine)
+{
+    if (engine == mOptimizationEngine) return;
+
+    mOptimizationEngine = engine;
+    emit optimizationEngineChanged();
+}
+
 void MainWindow::prepareDataPlot(
         DataPlot *plot)
 {
@@ -2819,8 +2557,11 @@ void MainWindow::closeReference()
 }
 
 void MainWindow::setOptimal(
-        const DataPoints &result)
+        const MainWindow::DataPoints &result)
 {
     m_optimal = result;
-    emit dataChanged();
+
+    // Only the optimal curves and scores depend on this, so spare the
+    // track caches and views a full refresh while an optimization runs
+    emit optimalChanged();
 }
@@ -31,13 +31,18 @@
 #include <QStack>
 #include <QVector>
 
+#include "channelcache.h"
 #include "dataplot.h"
 #include "datapoint.h"
 #include "dataview.h"
+#include "logbookstore.h"
+#include "trackdata.h"
+#include "trackprocessor.h"
 
 class MapView;
 class QCPRange;
 class QCustomPlot;
+class QFile;
 class ScoringMethod;
 class ScoringView;
 
@@ -70,6 +75,10 @@ public:
         Automatic, Fixed
     } GroundReference;
 
+    typedef enum {
+        Genetic, DifferentialEvolution, oeLast
+    } OptimizationEngine;
+
     typedef QVector< DataPoint > DataPoints;
 
     explicit MainWindow(QWidget *parent = 0);
@@ -78,6 +87,10 @@ public:
     const DataPoints &data() const { return m_data; }
     int dataSize() const { return m_data.size(); }
     const DataPoint &dataPoint(int i) const { return m_data[i]; }
+    const TrackData &track() const;
+
+    // Scaled values of a plot for every sample, cached until data changes
+    const QVector< double > &plotValues(const PlotValue *value) const;
 
     PlotValue::Units units() const { return m_units; }
 
@@ -131,13 +144,16 @@ public:
     double maxLD() const { return m_maxLD; }
 
     int simulationTime() const { return m_simulationTime; }
+    quint64 optimizationSeed() const { return mOptimizationSeed; }
+
+    void setOptimizationEngine(OptimizationEngine engine);
+    OptimizationEngine optimizationEngine() const { return mOptimizationEngine; }
 
     void setMinDrag(double minDrag);
     void setMaxLift(double maxLift);
     void setMaxLD(double maxLD);    
 
     const DataPoints &optimal() const { return m_optimal; }
-    void setOptimal(const DataPoints &result);
 
     int optimalSize() const { return m_optimal.size(); }
     const DataPoint &optimalPoint(int i) const { return m_optimal[i]; }
@@ -178,6 +194,13 @@ public:
 
     QString databasePath() const { return mDatabasePath; }
 
+    // Tracks for a batch optimization: the checked tracks, or the logbook
+    // selection if none are checked
+    QMap< QString, DataPoints > optimizationTracks();
+    bool saveOptimal(const QString &trackName, ScoringMode mode,
+                     double actualScore, double optimalScore,
+                     const DataPoints &result);
+
 protected:
     void closeEvent(QCloseEvent *event);
 
@@ -247,6 +270,10 @@ private:
     DataPoints            m_data;
     DataPoints            m_optimal;
 
+    mutable TrackData     mTrack;
+    mutable bool          mTrackValid;
+    mutable ChannelCache  mChannelCache;
+
     double                mMarkStart;
     double                mMarkEnd;
     bool                  mMarkActive;
@@ -284,6 +311,8 @@ private:
     double                m_maxLD;
 
     int                   m_simulationTime;
+    quint64               mOptimizationSeed;
+    OptimizationEngine    mOptimizationEngine;
 
     double                mLineThickness;
 
@@ -293,8 +322,10 @@ private:
     GroundReference       mGroundReference;
     double                mFixedReference;
 
+    TrackProcessor        mProcessor;
+
     QString               mDatabasePath;
-    QSqlDatabase          mDatabase;
+    LogbookStore          mLogbook;
 
     QString               mTrackName;
     QVector< QString >    mSelectedTracks;
@@ -307,6 +338,7 @@ private:
 
     void initDatabase();
     bool setDatabaseValue(QString trackName, QString column, QString value);
+    bool setDatabaseValues(QString trackName, QStringList columns, QVariantList values);
     bool getDatabaseValue(QString trackName, QString column, QString &value);
     void saveZoomToDatabase();
 
@@ -323,38 +355,45 @@ private:
     void initSingleView(const QString &title, const QString &objectName,
                         QAction *actionShow, DataView::Direction direction);
 
-    void import(QIODevice *device, DataPoints &data, QString trackName, bool initDatabase);
-    void initTime(DataPoints &data);
-    void initExit(DataPoints &data, QString trackName, bool initDatabase);
-    void initAltitude(DataPoints &data, QString trackName, bool initDatabase);
-    void initAcceleration(DataPoints &data);
-    void updateVelocity(DataPoints &data, QString trackName, bool initDatabase);
-    void initAerodynamics(DataPoints &data);
+    bool readTrack(const QString &uniqueName, DataPoints &data);
+    QString cachePath(const QString &uniqueName) const;
 
-    double getSlope(const int center, double (*value)(const DataPoint &)) const;
+    void import(QFile *file, DataPoints &data, QString trackName, bool initDatabase);
+    void import(const char *buffer, qint64 size, DataPoints &data, QString trackName, bool initDatabase);
+    void findFiles(QString folderName, QStringList &fileNames);
+    TrackProcessor::Parameters trackParameters(QString trackName);
+    void updateVelocity(DataPoints &data, QString trackName);
+    void updateAerodynamics(DataPoints &data, QString trackName);
 
     void initRange(QString trackName);
 
     void updateBottomActions();
     void updateLeftActions();
 
-    void updateGround(DataPoints &data, double ground);
-    QString dateTimeToUTC(const QDateTime &dt);
+    QString dateTimeToUTC(qint64 msecs);
 
 signals:
     void dataLoaded();
     void dataChanged();
+    void optimalChanged();
     void rangeChanged();
     void cursorChanged();
     void aeroChanged();
     void rotationChanged(double rotation);
     void databaseChanged();
+    void trackChanged(const QString &trackName);
+    void scoringModeChanged();
+    void optimizationEngineChanged();
 
 public slots:
+    void setOptimal(const MainWindow::DataPoints &result);
+
     void importFolder(QString folderName);
+    void importFiles(QStringList fileNames);
     void importFile(QString fileName);
 
 private slots:
+    void invalidateTrack();
     void setScoringVisible(bool visible);
     void saveZoom();
 };
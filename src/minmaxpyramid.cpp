@@ -0,0 +1,307 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "minmaxpyramid.h"
+
+#include <math.h>
+
+MinMaxPyramid::MinMaxPyramid():
+    mSorted(true)
+{
+
+}
+
+void MinMaxPyramid::build(
+        const QVector< double > &keys,
+        const QVector< double > &values)
+{
+    clear();
+
+    mKeys = keys;
+    mValues = values;
+
+    for (int i = 1; i < mKeys.size() && mSorted; ++i)
+    {
+        if (mKeys[i] < mKeys[i - 1])
+        {
+            mSorted = false;
+        }
+    }
+
+    // Levels follow sample order, so they serve sample ranges even when
+    // keys are unsorted. Level 1 pairs samples, each further level pairs buckets
+    const int n = mValues.size();
+    for (int size = 2; size / 2 < n; size *= 2)
+    {
+        Level level;
+
+        const int count = (n + size - 1) / size;
+        level.minIndex.resize(count);
+        level.maxIndex.resize(count);
+
+        for (int b = 0; b < count; ++b)
+        {
+            const int i = 2 * b, j = 2 * b + 1;
+
+            if (mLevels.isEmpty())
+            {
+                const int k = qMin(j, n - 1);
+                level.minIndex[b] = lessOf(i, k);
+                level.maxIndex[b] = greaterOf(i, k);
+            }
+            else
+            {
+                const Level &prev = mLevels.last();
+                const int k = qMin(j, prev.minIndex.size() - 1);
+                level.minIndex[b] = lessOf(prev.minIndex[i], prev.minIndex[k]);
+                level.maxIndex[b] = greaterOf(prev.maxIndex[i], prev.maxIndex[k]);
+            }
+        }
+
+        mLevels.append(level);
+    }
+}
+
+void MinMaxPyramid::clear()
+{
+    mKeys.clear();
+    mValues.clear();
+    mLevels.clear();
+    mSorted = true;
+}
+
+void MinMaxPyramid::extract(
+        double lower,
+        double upper,
+        int buckets,
+        QVector< double > &keys,
+        QVector< double > &values) const
+{
+    keys.clear();
+    values.clear();
+
+    if (!mSorted)
+    {
+        keys = mKeys;
+        values = mValues;
+        return;
+    }
+
+    const int n = mKeys.size();
+    if (n == 0) return;
+
+    // Visible samples plus one neighbour on each side
+    const int first = qMax(0, (int) (qLowerBound(mKeys.constBegin(), mKeys.constEnd(), lower) - mKeys.constBegin()) - 1);
+    const int last = qMin(n - 1, (int) (qUpperBound(mKeys.constBegin(), mKeys.constEnd(), upper) - mKeys.constBegin()));
+
+    const int count = last - first + 1;
+
+    // Coarsest level that still has a bucket per column
+    int levelIndex = -1;
+    while (levelIndex + 1 < mLevels.size()
+           && (count >> (levelIndex + 2)) >= qMax(buckets, 1))
+    {
+        ++levelIndex;
+    }
+
+    keys.reserve(2 * (count >> (levelIndex + 1)) + 4);
+    values.reserve(2 * (count >> (levelIndex + 1)) + 4);
+
+    if (levelIndex < 0)
+    {
+        for (int i = first; i <= last; ++i) append(i, keys, values);
+        return;
+    }
+
+    const Level &level = mLevels[levelIndex];
+    const int shift = levelIndex + 1;
+
+    append(first, keys, values);
+
+    const int bFirst = first >> shift;
+    const int bLast = last >> shift;
+    for (int b = bFirst; b <= bLast; ++b)
+    {
+        const int lo = b << shift;
+        const int hi = qMin(((b + 1) << shift) - 1, n - 1);
+
+        int i, j;
+        if (first <= lo && hi <= last)
+        {
+            i = level.minIndex[b];
+            j = level.maxIndex[b];
+        }
+        else
+        {
+            // Partial bucket at either end of the range
+            i = j = qMax(lo, first);
+            for (int k = i + 1; k <= qMin(hi, last); ++k)
+            {
+                i = lessOf(i, k);
+                j = greaterOf(j, k);
+            }
+        }
+
+        // Keep the pair in sample order so the line is drawn correctly
+        if (i < j)
+        {
+            append(i, keys, values);
+            append(j, keys, values);
+        }
+        else if (i > j)
+        {
+            append(j, keys, values);
+            append(i, keys, values);
+        }
+        else
+        {
+            append(i, keys, values);
+        }
+    }
+
+    append(last, keys, values);
+}
+
+bool MinMaxPyramid::bounds(
+        double lower,
+        double upper,
+        double &minimum,
+        double &maximum) const
+{
+    if (mSorted)
+    {
+        const int i = qLowerBound(mKeys.constBegin(), mKeys.constEnd(), lower) - mKeys.constBegin();
+        const int j = qUpperBound(mKeys.constBegin(), mKeys.constEnd(), upper) - mKeys.constBegin();
+
+        return query(i, j, minimum, maximum);
+    }
+
+    int iMin = -1, iMax = -1;
+    for (int i = 0; i < mKeys.size(); ++i)
+    {
+        if (mKeys[i] < lower || mKeys[i] > upper) continue;
+
+        iMin = (iMin < 0) ? i : lessOf(iMin, i);
+        iMax = (iMax < 0) ? i : greaterOf(iMax, i);
+    }
+
+    if (iMin < 0 || isnan(mValues[iMin])) return false;
+
+    minimum = mValues[iMin];
+    maximum = mValues[iMax];
+    return true;
+}
+
+bool MinMaxPyramid::sampleBounds(
+        int first,
+        int last,
+        double &minimum,
+        double &maximum) const
+{
+    return query(qMax(first, 0), qMin(last, mValues.size() - 1) + 1, minimum, maximum);
+}
+
+bool MinMaxPyramid::query(
+        int i,
+        int j,
+        double &minimum,
+        double &maximum) const
+{
+    int iMin = -1, iMax = -1;
+
+    // Samples in [i, j) at the current level, starting with raw samples.
+    // Take unpaired buckets at either end, then move up a level.
+    for (int level = -1; i < j && level < mLevels.size(); ++level)
+    {
+        if (i & 1)
+        {
+            const int k = minIndex(level, i), l = maxIndex(level, i);
+            iMin = (iMin < 0) ? k : lessOf(iMin, k);
+            iMax = (iMax < 0) ? l : greaterOf(iMax, l);
+            ++i;
+        }
+        if (j & 1)
+        {
+            --j;
+            const int k = minIndex(level, j), l = maxIndex(level, j);
+            iMin = (iMin < 0) ? k : lessOf(iMin, k);
+            iMax = (iMax < 0) ? l : greaterOf(iMax, l);
+        }
+
+        i >>= 1;
+        j >>= 1;
+    }
+
+    if (iMin < 0 || isnan(mValues[iMin])) return false;
+
+    minimum = mValues[iMin];
+    maximum = mValues[iMax];
+    return true;
+}
+
+int MinMaxPyramid::lessOf(
+        int i,
+        int j) const
+{
+    // Gaps (NaN) only win if both are gaps
+    if (isnan(mValues[i])) return j;
+    if (isnan(mValues[j])) return i;
+    return (mValues[j] < mValues[i]) ? j : i;
+}
+
+int MinMaxPyramid::greaterOf(
+        int i,
+        int j) const
+{
+    if (isnan(mValues[i])) return j;
+    if (isnan(mValues[j])) return i;
+    return (mValues[j] > mValues[i]) ? j : i;
+}
+
+int MinMaxPyramid::minIndex(
+        int level,
+        int b) const
+{
+    // Level -1 is the series itself
+    return (level < 0) ? b : mLevels[level].minIndex[b];
+}
+
+int MinMaxPyramid::maxIndex(
+        int level,
+        int b) const
+{
+    return (level < 0) ? b : mLevels[level].maxIndex[b];
+}
+
+void MinMaxPyramid::append(
+        int i,
+        QVector< double > &keys,
+        QVector< double > &values) const
+{
+    // Skip repeats where a bucket extreme is also an end point
+    if (!keys.isEmpty() && keys.last() == mKeys[i] && values.last() == mValues[i]) return;
+
+    keys.append(mKeys[i]);
+    values.append(mValues[i]);
+}
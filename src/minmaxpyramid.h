@@ -0,0 +1,80 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include <QVector>
+
+// Level-of-detail summary of one plotted series. Level L holds the
+// positions of the smallest and largest value in each run of 2^L samples,
+// so any range can be drawn from a few points per pixel without losing
+// peaks. The same levels answer min/max queries over a key range in
+// logarithmic time. Keys must be non-decreasing for key lookups;
+// otherwise the full series is used.
+class MinMaxPyramid
+{
+public:
+    MinMaxPyramid();
+
+    void build(const QVector< double > &keys, const QVector< double > &values);
+    void clear();
+
+    // Samples that draw [lower, upper] using about two points for each of
+    // buckets columns, plus one neighbour on each side
+    void extract(double lower, double upper, int buckets,
+                 QVector< double > &keys, QVector< double > &values) const;
+
+    // Smallest and largest value with lower <= key <= upper, ignoring
+    // gaps. Returns false if there are none.
+    bool bounds(double lower, double upper,
+                double &minimum, double &maximum) const;
+
+    // The same for samples first through last
+    bool sampleBounds(int first, int last,
+                      double &minimum, double &maximum) const;
+
+    bool sorted() const { return mSorted; }
+
+private:
+    typedef struct {
+        QVector< int > minIndex;
+        QVector< int > maxIndex;
+    } Level;
+
+    QVector< double > mKeys;
+    QVector< double > mValues;
+    QVector< Level >  mLevels;
+    bool              mSorted;
+
+    bool query(int i, int j, double &minimum, double &maximum) const;
+
+    int lessOf(int i, int j) const;
+    int greaterOf(int i, int j) const;
+    int minIndex(int level, int b) const;
+    int maxIndex(int level, int b) const;
+    void append(int i, QVector< double > &keys, QVector< double > &values) const;
+};
+
+#endif // MINMAXPYRAMID_H
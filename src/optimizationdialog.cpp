@@ -0,0 +1,181 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "optimizationdialog.h"
+
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QThread>
+#include <QVBoxLayout>
+
+#include "optimizationworker.h"
+#include "scoringmethod.h"
+
+OptimizationDialog::OptimizationDialog(
+        ScoringMethod *method,
+        OptimizationWorker *worker,
+        QWidget *parent):
+    QDialog(parent),
+    mMethod(method),
+    mWorker(worker),
+    mThread(new QThread),
+    mPaused(false),
+    mAbandoned(false)
+{
+    setWindowTitle(tr("Optimize"));
+    setAttribute(Qt::WA_DeleteOnClose);
+    setModal(false);
+
+    mLabel = new QLabel(tr("Initializing..."));
+    mCacheLabel = new QLabel;
+    mProgressBar = new QProgressBar;
+    mProgressBar->setRange(0, mWorker->maximum());
+    mProgressBar->setValue(0);
+
+    mPauseButton = new QPushButton(tr("Pause"));
+    mCancelButton = new QPushButton(tr("Abort"));
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(mPauseButton);
+    buttonLayout->addWidget(mCancelButton);
+
+    QVBoxLayout *layout = new QVBoxLayout;
+    layout->addWidget(mLabel);
+    layout->addWidget(mProgressBar);
+    layout->addWidget(mCacheLabel);
+    layout->addLayout(buttonLayout);
+    setLayout(layout);
+
+    mWorker->moveToThread(mThread);
+
+    connect(mThread, SIGNAL(started()), mWorker, SLOT(run()));
+    connect(mWorker, SIGNAL(finished()), mThread, SLOT(quit()));
+
+    connect(mWorker, SIGNAL(progressChanged(int)),
+            this, SLOT(onProgressChanged(int)));
+    connect(mWorker, SIGNAL(bestScoreChanged(double)),
+            this, SLOT(onBestScoreChanged(double)));
+    connect(mWorker, SIGNAL(cacheHitRateChanged(double)),
+            this, SLOT(onCacheHitRateChanged(double)));
+    connect(mWorker, SIGNAL(bestTrajectoryChanged(MainWindow::DataPoints)),
+            this, SLOT(onBestTrajectoryChanged(MainWindow::DataPoints)));
+    connect(mWorker, SIGNAL(finished()),
+            this, SLOT(onFinished()));
+
+    connect(mPauseButton, SIGNAL(clicked()), this, SLOT(onPauseButtonClicked()));
+    connect(mCancelButton, SIGNAL(clicked()), this, SLOT(reject()));
+}
+
+OptimizationDialog::~OptimizationDialog()
+{
+    // Only reached once the worker is done, or if it never started
+    mWorker->cancel();
+    mThread->wait();
+
+    delete mWorker;
+    delete mThread;
+}
+
+void OptimizationDialog::start()
+{
+    show();
+    mThread->start();
+}
+
+void OptimizationDialog::stop()
+{
+    mAbandoned = true;
+    mWorker->cancel();
+    mThread->wait();
+}
+
+void OptimizationDialog::reject()
+{
+    // Stop after the current generation; the dialog closes when the worker
+    // reports that it has finished
+    mWorker->cancel();
+
+    mLabel->setText(tr("Stopping..."));
+    mPauseButton->setEnabled(false);
+    mCancelButton->setEnabled(false);
+
+    if (!mThread->isRunning()) QDialog::reject();
+}
+
+void OptimizationDialog::abandon()
+{
+    mAbandoned = true;
+    reject();
+}
+
+void OptimizationDialog::onProgressChanged(
+        int value)
+{
+    mProgressBar->setValue(value);
+}
+
+void OptimizationDialog::onBestScoreChanged(
+        double score)
+{
+    if (!mCancelButton->isEnabled()) return;
+
+    // Show best score in progress dialog
+    QString labelText = mMethod->scoreAsText(score);
+    mLabel->setText(tr("Optimizing (best score is ") +
+                    labelText +
+                    tr(")..."));
+}
+
+void OptimizationDialog::onCacheHitRateChanged(
+        double rate)
+{
+    mCacheLabel->setText(tr("Cache hit rate: %1%").arg(rate * 100, 0, 'f', 1));
+}
+
+void OptimizationDialog::onBestTrajectoryChanged(
+        const MainWindow::DataPoints &result)
+{
+    // Results arrive queued from the worker thread, so some may still be
+    // pending after the run is abandoned
+    if (mAbandoned) return;
+
+    emit bestTrajectoryChanged(result);
+}
+
+void OptimizationDialog::onPauseButtonClicked()
+{
+    mPaused = !mPaused;
+    mWorker->setPaused(mPaused);
+
+    mPauseButton->setText(mPaused ? tr("Resume") : tr("Pause"));
+}
+
+void OptimizationDialog::onFinished()
+{
+    mThread->wait();
+    QDialog::reject();
+}
@@ -0,0 +1,90 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef OPTIMIZATIONDIALOG_H
+#define OPTIMIZATIONDIALOG_H
+
+#include <QDialog>
+
+#include "mainwindow.h"
+
+class OptimizationWorker;
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QThread;
+class ScoringMethod;
+
+// Non-modal progress window for a running optimization. Takes ownership of
+// the worker and its thread, and closes itself when the worker finishes.
+// Trajectories are passed on until the run is abandoned.
+class OptimizationDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    OptimizationDialog(ScoringMethod *method, OptimizationWorker *worker,
+                       QWidget *parent = 0);
+    ~OptimizationDialog();
+
+    void start();
+
+    // Cancels the run and waits for the worker thread, for when the
+    // scoring method is about to go away
+    void stop();
+
+public slots:
+    void reject();
+
+    // Stops the run and drops any results still on their way, e.g. when
+    // the track they were computed for is no longer shown
+    void abandon();
+
+signals:
+    void bestTrajectoryChanged(const MainWindow::DataPoints &result);
+
+private:
+    ScoringMethod      *mMethod;
+    OptimizationWorker *mWorker;
+    QThread            *mThread;
+
+    QLabel             *mLabel;
+    QLabel             *mCacheLabel;
+    QProgressBar       *mProgressBar;
+    QPushButton        *mPauseButton;
+    QPushButton        *mCancelButton;
+
+    bool                mPaused;
+    bool                mAbandoned;
+
+private slots:
+    void onProgressChanged(int value);
+    void onBestScoreChanged(double score);
+    void onCacheHitRateChanged(double rate);
+    void onBestTrajectoryChanged(const MainWindow::DataPoints &result);
+    void onPauseButtonClicked();
+    void onFinished();
+};
+
+#endif // OPTIMIZATIONDIALOG_H
@@ -0,0 +1,116 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "optimizationworker.h"
+
+#include <QMutexLocker>
+
+OptimizationWorker::OptimizationWorker(
+        ScoringMethod *method,
+        Optimizer *optimizer,
+        const Optimizer::Parameters &params,
+        QObject *parent):
+    QObject(parent),
+    mMethod(method),
+    mOptimizer(optimizer),
+    mParams(params),
+    mPaused(false),
+    mCanceled(false),
+    mHasBest(false),
+    mBestScore(0)
+{
+    qRegisterMetaType< MainWindow::DataPoints >("MainWindow::DataPoints");
+}
+
+OptimizationWorker::~OptimizationWorker()
+{
+    delete mOptimizer;
+}
+
+int OptimizationWorker::maximum() const
+{
+    return mOptimizer->maximum(mParams);
+}
+
+void OptimizationWorker::cancel()
+{
+    QMutexLocker locker(&mMutex);
+    mCanceled = true;
+    mResumed.wakeAll();
+}
+
+void OptimizationWorker::setPaused(
+        bool paused)
+{
+    QMutexLocker locker(&mMutex);
+    mPaused = paused;
+    mResumed.wakeAll();
+}
+
+bool OptimizationWorker::waitIfPaused()
+{
+    // Returns false once the optimization has been canceled
+    QMutexLocker locker(&mMutex);
+    while (mPaused && !mCanceled)
+    {
+        mResumed.wait(&mMutex);
+    }
+    return !mCanceled;
+}
+
+MainWindow::DataPoints OptimizationWorker::simulate(
+        const Genome &g) const
+{
+    MainWindow::DataPoints result;
+    Optimizer::simulate(mParams, g, result);
+    return result;
+}
+
+bool OptimizationWorker::report(
+        int progress,
+        const Score &best)
+{
+    emit progressChanged(progress);
+    emit cacheHitRateChanged(mOptimizer->cacheHitRate());
+
+    // Report improvements so the plot can follow the search
+    if (!mHasBest || best.first > mBestScore)
+    {
+        mHasBest = true;
+        mBestScore = best.first;
+        emit bestScoreChanged(mBestScore);
+        emit bestTrajectoryChanged(simulate(best.second));
+    }
+
+    return waitIfPaused();
+}
+
+void OptimizationWorker::run()
+{
+    const Score best = mOptimizer->optimize(mMethod, mParams, *this);
+
+    // Keep most fit individual
+    emit bestTrajectoryChanged(simulate(best.second));
+    emit finished();
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef OPTIMIZATIONWORKER_H
+#define OPTIMIZATIONWORKER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QWaitCondition>
+
+#include "mainwindow.h"
+#include "optimizer.h"
+
+class ScoringMethod;
+
+class OptimizationWorker : public QObject, private Optimizer::Context
+{
+    Q_OBJECT
+
+public:
+    // Takes ownership of the optimizer. The scoring method's score() is
+    // called from worker threads while the optimization runs.
+    OptimizationWorker(ScoringMethod *method, Optimizer *optimizer,
+                       const Optimizer::Parameters &params,
+                       QObject *parent = 0);
+    ~OptimizationWorker();
+
+    int maximum() const;
+
+    // Thread-safe; may be called from any thread
+    void cancel();
+    void setPaused(bool paused);
+
+public slots:
+    void run();
+
+signals:
+    void progressChanged(int value);
+    void bestScoreChanged(double score);
+    void cacheHitRateChanged(double rate);
+    void bestTrajectoryChanged(const MainWindow::DataPoints &result);
+    void finished();
+
+private:
+    ScoringMethod        *mMethod;
+    Optimizer            *mOptimizer;
+    Optimizer::Parameters mParams;
+
+    QMutex                mMutex;
+    QWaitCondition        mResumed;
+    bool                  mPaused;
+    bool                  mCanceled;
+
+    bool                  mHasBest;
+    double                mBestScore;
+
+    bool report(int progress, const Score &best);
+    bool waitIfPaused();
+    MainWindow::DataPoints simulate(const Genome &g) const;
+};
+
+#endif // OPTIMIZATIONWORKER_H
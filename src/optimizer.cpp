@@ -0,0 +1,555 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "optimizer.h"
+
+#include <QThreadStorage>
+#include <QtConcurrent>
+
+#include <math.h>
+
+#include "batchsimulator.h"
+#include "differentialevolution.h"
+#include "geneticoptimizer.h"
+
+namespace
+{
+
+// Individuals simulated together in one BatchSimulator pass
+const int LANES = 16;
+
+// Cached scores kept before the cache starts over
+const int CACHE_SIZE = 4096;
+
+// Correction pairs kept by L-BFGS
+const int HISTORY = 6;
+
+// Sufficient decrease constant for the line search
+const double ARMIJO = 1e-4;
+
+typedef struct {
+    Score *first;
+    int    count;
+} Batch;
+
+// Trajectory buffers for each pool thread, reused for every batch that
+// thread scores
+QThreadStorage< QVector< MainWindow::DataPoints > > buffers;
+
+class Evaluator
+{
+public:
+    Evaluator(ScoringMethod *method,
+              const Optimizer::Parameters &params):
+        mMethod(method),
+        mParams(params)
+    {
+    }
+
+    void operator()(Batch &batch) const
+    {
+        const Optimizer::Parameters &p = mParams;
+
+        QVector< MainWindow::DataPoints > &results = buffers.localData();
+        results.resize(LANES);
+
+        if (p.integrationTolerance > 0)
+        {
+            // Adaptive steps differ between individuals, so run them
+            // one at a time
+            for (int j = 0; j < batch.count; ++j)
+            {
+                Optimizer::simulate(p, batch.first[j].second, results[j]);
+                batch.first[j].first = mMethod->score(results[j]);
+            }
+            return;
+        }
+
+        const Genome *genomes[LANES];
+        for (int j = 0; j < batch.count; ++j)
+        {
+            genomes[j] = &batch.first[j].second;
+        }
+
+        // Integrate the whole batch in lockstep
+        BatchSimulator simulator(p.dt, p.a, p.c, p.planformArea, p.mass, p.dp0, p.windowBottom);
+        simulator.simulate(genomes, batch.count, results.data());
+
+        for (int j = 0; j < batch.count; ++j)
+        {
+            batch.first[j].first = mMethod->score(results[j]);
+        }
+    }
+
+private:
+    ScoringMethod               *mMethod;
+    const Optimizer::Parameters &mParams;
+};
+
+QByteArray genomeKey(
+        const Genome &g)
+{
+    return QByteArray((const char *) g.constData(), g.size() * sizeof(double));
+}
+
+Genome correct(
+        const Genome &g,
+        const Genome &correction,
+        const Optimizer::Parameters &p)
+{
+    Genome result = g;
+    for (int i = 0; i < result.size(); ++i)
+    {
+        result[i] = qBound(p.minLift, g[i] + correction[i], p.maxLift);
+    }
+    return result;
+}
+
+} // namespace
+
+Optimizer::Optimizer():
+    mLookups(0),
+    mHits(0)
+{
+
+}
+
+Optimizer *Optimizer::create(
+        MainWindow::OptimizationEngine engine)
+{
+    switch (engine)
+    {
+    case MainWindow::DifferentialEvolution:
+        return new DifferentialEvolution;
+    default:
+        return new GeneticOptimizer;
+    }
+}
+
+void Optimizer::simulate(
+        const Parameters &params,
+        const Genome &g,
+        MainWindow::DataPoints &result)
+{
+    const Parameters &p = params;
+    if (p.integrationTolerance > 0)
+    {
+        g.simulateAdaptive(p.dt, p.a, p.c, p.planformArea, p.mass, p.dp0, p.windowBottom,
+                           p.integrationTolerance, result);
+    }
+    else
+    {
+        g.simulate(p.dt, p.a, p.c, p.planformArea, p.mass, p.dp0, p.windowBottom, result);
+    }
+}
+
+QByteArray Optimizer::parametersKey(
+        const Parameters &p)
+{
+    const double values[] = {
+        p.dt, p.a, p.c, p.planformArea, p.mass, p.windowBottom,
+        p.integrationTolerance,
+        p.dp0.t, p.dp0.vx, p.dp0.vy, p.dp0.velD,
+        p.dp0.hMSL, p.dp0.z, p.dp0.dist2D, p.dp0.dist3D
+    };
+    return QByteArray((const char *) values, sizeof(values));
+}
+
+double Optimizer::cacheHitRate() const
+{
+    if (mLookups == 0) return 0;
+    return (double) mHits / mLookups;
+}
+
+void Optimizer::evaluate(
+        ScoringMethod *method,
+        const Parameters &params,
+        GenePool &pool,
+        int first)
+{
+    // Scores are only comparable under the same simulation parameters
+    const QByteArray paramsKey = parametersKey(params);
+    if (paramsKey != mCacheParams)
+    {
+        mCacheParams = paramsKey;
+        mCache.clear();
+    }
+
+    // Collect distinct genomes we have not scored yet
+    GenePool pending;
+    QVector< QByteArray > pendingKeys;
+    QHash< QByteArray, int > pendingIndex;
+    QVector< int > source(pool.size(), -1);
+
+    for (int i = first; i < pool.size(); ++i)
+    {
+        const QByteArray key = genomeKey(pool[i].second);
+
+        ++mLookups;
+
+        QHash< QByteArray, double >::const_iterator cached = mCache.constFind(key);
+        if (cached != mCache.constEnd())
+        {
+            pool[i].first = cached.value();
+            ++mHits;
+            continue;
+        }
+
+        QHash< QByteArray, int >::const_iterator dup = pendingIndex.constFind(key);
+        if (dup != pendingIndex.constEnd())
+        {
+            source[i] = dup.value();
+            ++mHits;
+            continue;
+        }
+
+        source[i] = pending.size();
+        pendingIndex.insert(key, pending.size());
+        pendingKeys.append(key);
+        pending.append(pool[i]);
+    }
+
+    QVector< Batch > batches;
+    for (int i = 0; i < pending.size(); i += LANES)
+    {
+        Batch batch;
+        batch.first = pending.data() + i;
+        batch.count = qMin(LANES, pending.size() - i);
+        batches.append(batch);
+    }
+
+    QtConcurrent::blockingMap(batches, Evaluator(method, params));
+
+    for (int i = first; i < pool.size(); ++i)
+    {
+        if (source[i] >= 0) pool[i].first = pending[source[i]].first;
+    }
+
+    // Start over rather than grow without bound
+    if (mCache.size() + pending.size() > CACHE_SIZE) mCache.clear();
+
+    for (int i = 0; i < pending.size(); ++i)
+    {
+        mCache.insert(pendingKeys[i], pending[i].first);
+    }
+}
+
+Genome Optimizer::expand(
+        const Points &points,
+        int genomeSize)
+{
+    const int parts = points.size() - 1;
+    const int partSize = (genomeSize - 1) / parts;
+
+    Genome g;
+    g.reserve(genomeSize);
+
+    for (int i = 0; i < parts; ++i)
+    {
+        for (int j = 0; j < partSize; ++j)
+        {
+            g.append(points[i] + (double) j / partSize * (points[i + 1] - points[i]));
+        }
+    }
+    g.append(points.last());
+
+    return g;
+}
+
+int Optimizer::polishMaximum(
+        const Parameters &params)
+{
+    // Central differences plus one batch of line search trials
+    const int n = (1 << params.kMax) + 1;
+    return params.polishIterations * (2 * n + 1 + LANES);
+}
+
+bool Optimizer::polish(
+        ScoringMethod *method,
+        const Parameters &params,
+        Score &best,
+        int &progress,
+        Context &context)
+{
+    const Parameters &p = params;
+    if (p.polishIterations <= 0) return true;
+
+    const int parts = 1 << p.kMax;
+    const int n = parts + 1;
+
+    // Search over a piecewise linear correction to the starting genome,
+    // so the search starts exactly where the engine left off
+    const Genome start = best.second;
+    const double range = p.maxLift - p.minLift;
+    const double lower = -range, upper = range;
+    const double delta = 1e-4 * range;
+
+    const int progressStart = progress;
+
+    // Minimize the negative score
+    Points x(n, 0.0);
+
+    double f = 0;
+    Points g(n);
+
+    QVector< Points > s, y;
+    bool pending = false;
+    bool running = true;
+
+    for (int iter = 0; iter < p.polishIterations && running; ++iter)
+    {
+        // Score the current point and its neighbours along each axis
+        GenePool pool;
+        pool.reserve(2 * n + 1);
+        pool.append(Score(0, correct(start, expand(x, p.genomeSize), p)));
+        for (int i = 0; i < n; ++i)
+        {
+            Points xp = x, xm = x;
+            xp[i] = qMin(x[i] + delta, upper);
+            xm[i] = qMax(x[i] - delta, lower);
+            pool.append(Score(0, correct(start, expand(xp, p.genomeSize), p)));
+            pool.append(Score(0, correct(start, expand(xm, p.genomeSize), p)));
+        }
+
+        evaluate(method, p, pool);
+
+        f = -pool[0].first;
+        for (int i = 0; i < n; ++i)
+        {
+            const double dp = qMin(x[i] + delta, upper) - x[i];
+            const double dm = x[i] - qMax(x[i] - delta, lower);
+
+            g[i] = -(pool[2 * i + 1].first - pool[2 * i + 2].first) / (dp + dm);
+
+            // A score that jumps on one side (e.g. the track no longer
+            // reaches the window) would swamp the gradient, so use the
+            // smoother one-sided difference there
+            if (dp > 0 && dm > 0)
+            {
+                const double forward  = -(pool[2 * i + 1].first - pool[0].first) / dp;
+                const double backward = -(pool[0].first - pool[2 * i + 2].first) / dm;
+                if (fabs(forward - backward) > qMax(fabs(forward), fabs(backward)))
+                {
+                    g[i] = (fabs(forward) < fabs(backward)) ? forward : backward;
+                }
+            }
+        }
+
+        if (pool[0].first > best.first) best = pool[0];
+
+        // Complete the curvature pair for the last step, dropping it if it
+        // would make the Hessian estimate indefinite
+        if (pending)
+        {
+            Points &yl = y.last();
+            double sy = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                yl[i] = g[i] - yl[i];
+                sy += s.last()[i] * yl[i];
+            }
+            if (sy <= 1e-12)
+            {
+                s.removeLast();
+                y.removeLast();
+            }
+            pending = false;
+        }
+
+        // Variables held at a bound by the gradient stay fixed
+        QVector< bool > free(n);
+        for (int i = 0; i < n; ++i)
+        {
+            free[i] = !((x[i] <= lower && g[i] > 0) || (x[i] >= upper && g[i] < 0));
+        }
+
+        // Two-loop recursion for the search direction
+        // See https://en.wikipedia.org/wiki/Limited-memory_BFGS
+        Points d(n);
+        for (int i = 0; i < n; ++i) d[i] = free[i] ? -g[i] : 0;
+
+        QVector< double > alpha(s.size());
+        for (int j = s.size() - 1; j >= 0; --j)
+        {
+            double sd = 0, sy = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                sd += s[j][i] * d[i];
+                sy += s[j][i] * y[j][i];
+            }
+            alpha[j] = sd / sy;
+            for (int i = 0; i < n; ++i) d[i] -= alpha[j] * y[j][i];
+        }
+
+        double scale;
+        if (s.isEmpty())
+        {
+            // First step moves the largest component a tenth of the range
+            double dMax = 0;
+            for (int i = 0; i < n; ++i) dMax = qMax(dMax, fabs(d[i]));
+            if (dMax == 0) break;
+            scale = 0.1 * (upper - lower) / dMax;
+        }
+        else
+        {
+            const Points &sl = s.last(), &yl = y.last();
+            double sy = 0, yy = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                sy += sl[i] * yl[i];
+                yy += yl[i] * yl[i];
+            }
+            scale = sy / yy;
+        }
+        for (int i = 0; i < n; ++i) d[i] *= scale;
+
+        for (int j = 0; j < s.size(); ++j)
+        {
+            double yd = 0, sy = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                yd += y[j][i] * d[i];
+                sy += s[j][i] * y[j][i];
+            }
+            const double beta = yd / sy;
+            for (int i = 0; i < n; ++i) d[i] += s[j][i] * (alpha[j] - beta);
+        }
+
+        // Fall back to steepest descent if curvature information misleads
+        double gd = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            if (!free[i]) d[i] = 0;
+            gd += g[i] * d[i];
+        }
+        if (gd >= 0)
+        {
+            s.clear();
+            y.clear();
+            for (int i = 0; i < n; ++i) d[i] = free[i] ? -g[i] : 0;
+        }
+
+        // Try halving step lengths along the projected path in one batch
+        QVector< Points > trials(LANES);
+        GenePool trialPool;
+        trialPool.reserve(LANES);
+        for (int j = 0; j < LANES; ++j)
+        {
+            const double step = ldexp(1.0, -j);
+            trials[j].resize(n);
+            for (int i = 0; i < n; ++i)
+            {
+                trials[j][i] = qBound(lower, x[i] + step * d[i], upper);
+            }
+            trialPool.append(Score(0, correct(start, expand(trials[j], p.genomeSize), p)));
+        }
+
+        evaluate(method, p, trialPool);
+
+        // Longest step with sufficient decrease, otherwise the best one
+        int accepted = -1;
+        for (int j = 0; j < LANES && accepted < 0; ++j)
+        {
+            double decrease = 0;
+            for (int i = 0; i < n; ++i) decrease += g[i] * (trials[j][i] - x[i]);
+            if (-trialPool[j].first <= f + ARMIJO * decrease) accepted = j;
+        }
+        if (accepted < 0)
+        {
+            for (int j = 0; j < LANES; ++j)
+            {
+                if (-trialPool[j].first < f
+                        && (accepted < 0 || trialPool[j].first > trialPool[accepted].first))
+                {
+                    accepted = j;
+                }
+            }
+        }
+
+        progress += 2 * n + 1 + LANES;
+
+        if (accepted < 0)
+        {
+            running = context.report(progress, best);
+            break;
+        }
+
+        if (trialPool[accepted].first > best.first) best = trialPool[accepted];
+
+        // The gradient at the new point is only known next iteration, so
+        // keep the step and the old gradient and finish the pair there
+        Points step(n);
+        for (int i = 0; i < n; ++i) step[i] = trials[accepted][i] - x[i];
+        x = trials[accepted];
+
+        s.append(step);
+        y.append(g);
+        pending = true;
+        if (s.size() > HISTORY)
+        {
+            s.remove(0);
+            y.remove(0);
+        }
+
+        running = context.report(progress, best);
+    }
+
+    // Count skipped iterations as done
+    if (running)
+    {
+        progress = progressStart + polishMaximum(p);
+        running = context.report(progress, best);
+    }
+
+    return running;
+}
+
+Optimizer::Convergence::Convergence(
+        const Parameters &params):
+    mParams(params),
+    mGenerations(0),
+    mStall(0)
+{
+
+}
+
+bool Optimizer::Convergence::update(
+        double bestScore)
+{
+    if (mGenerations == 0
+            || bestScore - mBestScore > mParams.tolerance * qMax(fabs(mBestScore), 1e-9))
+    {
+        mBestScore = bestScore;
+        mStall = 0;
+    }
+    else
+    {
+        ++mStall;
+    }
+
+    ++mGenerations;
+
+    return mGenerations >= mParams.maxGenerations
+            || mStall >= mParams.stallGenerations;
+}
@@ -0,0 +1,142 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <QByteArray>
+#include <QHash>
+
+#include "datapoint.h"
+#include "genome.h"
+#include "mainwindow.h"
+#include "scoringmethod.h"
+
+// Search for the lift coefficient schedule that maximizes a scoring
+// method's score. Genomes are piecewise linear between 2^k + 1 control
+// points, and every engine works from level kMin up to kMax.
+class Optimizer
+{
+public:
+    typedef struct {
+        double    dt;               // Time step (s)
+        double    a, c;             // Drag polar
+        double    planformArea;
+        double    mass;
+        DataPoint dp0;
+        double    windowBottom;
+        double    integrationTolerance; // Zero for fixed RK4 steps
+
+        int       genomeSize;
+        int       kMin, kMax;       // Levels of detail
+        double    minLift, maxLift;
+
+        int       maxGenerations;   // Generations per level of detail
+        int       stallGenerations; // Stop a level after this many...
+        double    tolerance;        // ...generations improving less than this
+
+        int       polishIterations; // L-BFGS iterations after the search
+
+        quint64   seed;
+    } Parameters;
+
+    // Implemented by whoever runs the optimizer
+    class Context
+    {
+    public:
+        virtual ~Context() {}
+
+        // Called once per generation. Blocks while paused and returns
+        // false once the run should stop.
+        virtual bool report(int progress, const Score &best) = 0;
+    };
+
+    Optimizer();
+    virtual ~Optimizer() {}
+
+    static Optimizer *create(MainWindow::OptimizationEngine engine);
+
+    // Upper bound on the progress values passed to Context::report
+    virtual int maximum(const Parameters &params) const = 0;
+
+    virtual Score optimize(ScoringMethod *method, const Parameters &params,
+                           Context &context) = 0;
+
+    // Simulates one genome with the integrator chosen in params
+    static void simulate(const Parameters &params, const Genome &g,
+                         MainWindow::DataPoints &result);
+
+    // Fraction of evaluations answered without simulating
+    double cacheHitRate() const;
+
+    // Everything the simulation reads apart from the genome, so two runs
+    // with the same key score genomes identically
+    static QByteArray parametersKey(const Parameters &params);
+
+protected:
+    typedef QVector< double > Points;
+
+    // Piecewise linear genome through evenly spaced control points
+    static Genome expand(const Points &points, int genomeSize);
+
+    // Upper bound on the progress polish() adds
+    static int polishMaximum(const Parameters &params);
+
+    // Local refinement of best with projected L-BFGS, using finite-
+    // difference gradients. The variables are a piecewise linear
+    // correction through the control points of the finest level.
+    // Returns false if the context stopped the run.
+    bool polish(ScoringMethod *method, const Parameters &params,
+                Score &best, int &progress, Context &context);
+
+    // Scores pool[first..] in parallel. Genomes seen before in this run
+    // take their score from the fitness cache.
+    void evaluate(ScoringMethod *method, const Parameters &params,
+                  GenePool &pool, int first = 0);
+
+    // Tracks the best score within a level of detail
+    class Convergence
+    {
+    public:
+        explicit Convergence(const Parameters &params);
+
+        // Returns true once the level has stopped improving or used up
+        // its generations
+        bool update(double bestScore);
+
+    private:
+        const Parameters &mParams;
+        double            mBestScore;
+        int               mGenerations;
+        int               mStall;
+    };
+
+private:
+    QByteArray                  mCacheParams;
+    QHash< QByteArray, double > mCache;
+    qint64                      mLookups;
+    qint64                      mHits;
+};
+
+#endif // OPTIMIZER_H
@@ -31,6 +31,7 @@
 #include "QCustomPlot/qcustomplot.h"
 
 #include "datapoint.h"
+#include "trackdata.h"
 
 #define METERS_TO_FEET 3.28084
 #define MPS_TO_MPH     2.23694
@@ -71,6 +72,10 @@ public:
     }
 
     virtual double rawValue(const DataPoint &dp) const = 0;
+
+    // Track channel holding the raw value, or -1 if it is derived
+    virtual int channel() const { return -1; }
+
     virtual double factor(Units units) const
     {
         Q_UNUSED(units);
@@ -166,6 +171,10 @@ public:
     {
         return DataPoint::elevation(dp);
     }
+    int channel() const
+    {
+        return TrackData::Z;
+    }
     double factor(Units units) const
     {
         return (units == Metric) ? 1
@@ -194,6 +203,10 @@ public:
     {
         return DataPoint::verticalSpeed(dp);
     }
+    int channel() const
+    {
+        return TrackData::VelD;
+    }
     double factor(Units units) const
     {
         return (units == Metric) ? MPS_TO_KMH
@@ -301,6 +314,10 @@ public:
     {
         return DataPoint::curvature(dp);
     }
+    int channel() const
+    {
+        return TrackData::Curv;
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -347,6 +364,10 @@ public:
     {
         return DataPoint::horizontalAccuracy(dp);
     }
+    int channel() const
+    {
+        return TrackData::HAcc;
+    }
     double factor(Units units) const
     {
         return (units == Metric) ? 1
@@ -373,6 +394,10 @@ public:
     {
         return DataPoint::verticalAccuracy(dp);
     }
+    int channel() const
+    {
+        return TrackData::VAcc;
+    }
     double factor(Units units) const
     {
         return (units == Metric) ? 1
@@ -399,6 +424,10 @@ public:
     {
         return DataPoint::speedAccuracy(dp);
     }
+    int channel() const
+    {
+        return TrackData::SAcc;
+    }
     double factor(Units units) const
     {
         return (units == Metric) ? MPS_TO_KMH
@@ -425,6 +454,10 @@ public:
     {
         return DataPoint::numberOfSatellites(dp);
     }
+    int channel() const
+    {
+        return TrackData::NumSV;
+    }
 };
 
 class PlotTime: public PlotValue
@@ -446,6 +479,10 @@ public:
     {
         return DataPoint::time(dp);
     }
+    int channel() const
+    {
+        return TrackData::T;
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -469,6 +506,10 @@ public:
     {
         return DataPoint::distance2D(dp);
     }
+    int channel() const
+    {
+        return TrackData::Dist2D;
+    }
     double factor(Units units) const
     {
         return (units == Metric) ? 1
@@ -497,6 +538,10 @@ public:
     {
         return DataPoint::distance3D(dp);
     }
+    int channel() const
+    {
+        return TrackData::Dist3D;
+    }
     double factor(Units units) const
     {
         return (units == Metric) ? 1
@@ -525,6 +570,10 @@ public:
     {
         return DataPoint::acceleration(dp);
     }
+    int channel() const
+    {
+        return TrackData::Accel;
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -548,6 +597,10 @@ public:
     {
         return DataPoint::accForward(dp);
     }
+    int channel() const
+    {
+        return TrackData::AX;
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -571,6 +624,10 @@ public:
     {
         return DataPoint::accRight(dp);
     }
+    int channel() const
+    {
+        return TrackData::AY;
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -594,6 +651,10 @@ public:
     {
         return DataPoint::accDown(dp);
     }
+    int channel() const
+    {
+        return TrackData::AZ;
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -617,6 +678,10 @@ public:
     {
         return DataPoint::accMagnitude(dp);
     }
+    int channel() const
+    {
+        return TrackData::AMag;
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -686,6 +751,10 @@ public:
     {
         return DataPoint::liftCoefficient(dp);
     }
+    int channel() const
+    {
+        return TrackData::Lift;
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -709,6 +778,10 @@ public:
     {
         return DataPoint::dragCoefficient(dp);
     }
+    int channel() const
+    {
+        return TrackData::Drag;
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -732,6 +805,10 @@ public:
     {
         return DataPoint::course(dp);
     }
+    int channel() const
+    {
+        return TrackData::Theta;
+    }
 
     bool hasOptimal() const { return false; }
 };
@@ -755,6 +832,10 @@ public:
     {
         return DataPoint::courseRate(dp);
     }
+    int channel() const
+    {
+        return TrackData::Omega;
+    }
 
     bool hasOptimal() const { return false; }
 };
@@ -778,6 +859,10 @@ public:
     {
         return DataPoint::courseAccuracy(dp);
     }
+    int channel() const
+    {
+        return TrackData::CAcc;
+    }
 
     bool hasOptimal() const { return false; }
 };
@@ -54,6 +54,13 @@ PPCForm::PPCForm(QWidget *parent) :
     connect(ui->actualButton, SIGNAL(clicked()), this, SLOT(onActualButtonClicked()));
     connect(ui->optimalButton, SIGNAL(clicked()), this, SLOT(onOptimalButtonClicked()));
     connect(ui->optimizeButton, SIGNAL(clicked()), this, SLOT(onOptimizeButtonClicked()));
+    connect(ui->optimizeAllButton, SIGNAL(clicked()), this, SLOT(onOptimizeAllButtonClicked()));
+
+    // Optimization engines in MainWindow::OptimizationEngine order
+    ui->engineComboBox->addItem(tr("Genetic algorithm"));
+    ui->engineComboBox->addItem(tr("Differential evolution"));
+    connect(ui->engineComboBox, SIGNAL(activated(int)), this, SLOT(onEngineChanged(int)));
+    connect(ui->toleranceEdit, SIGNAL(editingFinished()), this, SLOT(onToleranceChanged()));
 
     // Connect PPC button
     connect(ui->ppcButton, SIGNAL(clicked()), this, SLOT(onPpcButtonClicked()));
@@ -74,6 +81,10 @@ void PPCForm::setMainWindow(
         MainWindow *mainWindow)
 {
     mMainWindow = mainWindow;
+
+    // The engine is shared by all forms, so follow changes made elsewhere
+    connect(mMainWindow, SIGNAL(optimizationEngineChanged()),
+            this, SLOT(updateEngine()));
 }
 
 void PPCForm::updateView()
@@ -81,6 +92,9 @@ void PPCForm::updateView()
     // Update mode selection
     ui->actualButton->setChecked(mMainWindow->windowMode() == MainWindow::Actual);
     ui->optimalButton->setChecked(mMainWindow->windowMode() == MainWindow::Optimal);
+    updateEngine();
+    ui->toleranceEdit->setText(QString("%1").arg(
+                                   mMainWindow->scoringMethod(MainWindow::PPC)->integrationTolerance()));
 
     PPCScoring *method = (PPCScoring *) mMainWindow->scoringMethod(MainWindow::PPC);
 
@@ -232,6 +246,37 @@ void PPCForm::onOptimizeButtonClicked()
     mMainWindow->setWindowMode(MainWindow::Optimal);
 }
 
+void PPCForm::onOptimizeAllButtonClicked()
+{
+    PPCScoring *method = (PPCScoring *) mMainWindow->scoringMethod(MainWindow::PPC);
+    method->optimizeAll();
+}
+
+void PPCForm::updateEngine()
+{
+    ui->engineComboBox->setCurrentIndex(mMainWindow->optimizationEngine());
+}
+
+void PPCForm::onEngineChanged(
+        int index)
+{
+    mMainWindow->setOptimizationEngine((MainWindow::OptimizationEngine) index);
+}
+
+void PPCForm::onToleranceChanged()
+{
+    // Zero selects fixed RK4 steps
+    double tolerance = ui->toleranceEdit->text().toDouble();
+    if (tolerance < 0) tolerance = 0;
+
+    PPCScoring *method = (PPCScoring *) mMainWindow->scoringMethod(MainWindow::PPC);
+    method->setIntegrationTolerance(tolerance);
+
+    ui->toleranceEdit->setText(QString("%1").arg(tolerance));
+
+    mMainWindow->setFocus();
+}
+
 void PPCForm::onPpcButtonClicked() {
 
     // Return if plot empty
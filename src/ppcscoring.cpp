@@ -23,6 +23,8 @@
 
 #include "ppcscoring.h"
 
+#include <QSettings>
+
 #include "mainwindow.h"
 
 PPCScoring::PPCScoring(
@@ -224,3 +226,21 @@ bool PPCScoring::getWindowBounds(
         return false;
     }
 }
+
+void PPCScoring::readSettings()
+{
+    QSettings settings("FlySight", "Viewer");
+
+    settings.beginGroup("ppcScoring");
+        readIntegrationTolerance(settings);
+    settings.endGroup();
+}
+
+void PPCScoring::writeSettings()
+{
+    QSettings settings("FlySight", "Viewer");
+
+    settings.beginGroup("ppcScoring");
+        writeIntegrationTolerance(settings);
+    settings.endGroup();
+}
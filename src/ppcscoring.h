@@ -53,6 +53,10 @@ public:
                          DataPoint &dpBottom, DataPoint &dpTop);
 
     void optimize() { ScoringMethod::optimize(mMainWindow, mWindowBottom); }
+    void optimizeAll() { ScoringMethod::optimizeAll(mMainWindow, mWindowBottom); }
+
+    void readSettings();
+    void writeSettings();
 
 private:
     MainWindow *mMainWindow;
@@ -23,6 +23,8 @@
 **  PPC Website:      http://ppc.paralog.net/                             **
 ****************************************************************************/
 
+#include <QDateTime>
+
 #include "ppcupload.h"
 #include "ui_getuserdialog.h"
 
@@ -96,7 +98,7 @@ void PPCUpload::upload(const QString type, const double windowTop, const double
         post += "QNE="+QString::number(mMainWindow->getQNE())+"&";
         post += "Equipment="+QUrl::toPercentEncoding(equipment)+"&";
         post += "Type="+type+"&";
-        post += "Timestamp="+mMainWindow->dataPoint(mMainWindow->findIndexBelowT(0.0)).dateTime.toString(Qt::ISODate)+"&";
+        post += "Timestamp="+QDateTime::fromMSecsSinceEpoch(mMainWindow->dataPoint(mMainWindow->findIndexBelowT(0.0)).timestamp, Qt::UTC).toString(Qt::ISODate)+"&";
         post += "WindowBegin="+QString::number(windowTop)+"&";
         post += "WindowEnd="+QString::number(windowBottom)+"&";
         post += "WindDir="+QString::number(windDirection)+"&";
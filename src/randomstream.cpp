@@ -0,0 +1,80 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "randomstream.h"
+
+RandomStream::RandomStream(
+        quint64 seed):
+    mState(mix(seed))
+{
+
+}
+
+RandomStream::RandomStream(
+        quint64 seed,
+        int level,
+        int generation,
+        int index)
+{
+    // Fold each part of the key through the mixer so that neighbouring
+    // keys give unrelated streams
+    quint64 x = mix(seed);
+    x = mix(x ^ (quint32) level);
+    x = mix(x ^ (quint32) generation);
+    x = mix(x ^ (quint32) index);
+    mState = x;
+}
+
+quint32 RandomStream::next()
+{
+    // xorshift64* (see Vigna, "An experimental exploration of Marsaglia's
+    // xorshift generators, scrambled")
+    mState ^= mState >> 12;
+    mState ^= mState << 25;
+    mState ^= mState >> 27;
+    return (quint32) ((mState * Q_UINT64_C(2685821657736338717)) >> 32);
+}
+
+int RandomStream::bounded(
+        int n)
+{
+    return (int) (((quint64) next() * (quint32) n) >> 32);
+}
+
+double RandomStream::uniform()
+{
+    return next() / 4294967295.0;
+}
+
+quint64 RandomStream::mix(
+        quint64 x)
+{
+    // splitmix64 finalizer. xorshift can't leave the all-zero state, so
+    // that one output is replaced.
+    x += Q_UINT64_C(0x9e3779b97f4a7c15);
+    x = (x ^ (x >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+    x = x ^ (x >> 31);
+    return x ? x : Q_UINT64_C(0x9e3779b97f4a7c15);
+}
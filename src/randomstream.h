@@ -0,0 +1,54 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <QtGlobal>
+
+// Small self-contained pseudo-random generator. Each stream is derived
+// from a key rather than shared, so results don't depend on which thread
+// draws from which stream or in what order.
+class RandomStream
+{
+public:
+    explicit RandomStream(quint64 seed = 0);
+    RandomStream(quint64 seed, int level, int generation, int index);
+
+    // Uniform on [0, 2^32)
+    quint32 next();
+
+    // Uniform on [0, n)
+    int bounded(int n);
+
+    // Uniform on [0, 1]
+    double uniform();
+
+private:
+    quint64 mState;
+
+    static quint64 mix(quint64 x);
+};
+
+#endif // RANDOMSTREAM_H
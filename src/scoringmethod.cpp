@@ -21,190 +21,215 @@
 **  Website: http://flysight.ca/                                          **
 ****************************************************************************/
 
-#include <QProgressDialog>
+#include <QDateTime>
+#include <QMessageBox>
+#include <QPointer>
+#include <QSettings>
 
+#include "batchoptimizationdialog.h"
+#include "batchoptimizationworker.h"
 #include "mainwindow.h"
+#include "optimizationdialog.h"
+#include "optimizationworker.h"
+#include "optimizer.h"
 #include "scoringmethod.h"
 
-ScoringMethod::ScoringMethod(QObject *parent) : QObject(parent)
+namespace
 {
 
-}
+// Only one optimization runs at a time since they all write the same
+// optimal track
+QPointer< OptimizationDialog > activeDialog;
 
-void ScoringMethod::optimize(
+// What the active optimization started from, so data edits that change
+// its simulation can abandon it
+ScoringMethod *activeMethod;
+MainWindow *activeMainWindow;
+Optimizer::Parameters activeParams;
+
+// Batches only write to the logbook, so one can run alongside
+QPointer< BatchOptimizationDialog > activeBatchDialog;
+
+// Optimizer settings for a track, starting from its exit
+Optimizer::Parameters parameters(
         MainWindow *mainWindow,
-        double windowBottom)
+        const MainWindow::DataPoints &data,
+        double windowBottom,
+        double integrationTolerance)
 {
-    const DataPoint &dp0 = mainWindow->interpolateDataT(0);
+    Optimizer::Parameters params;
+
+    params.dp0 = TrackProcessor::interpolateDataT(data, 0);
 
     // y = ax^2 + c
     const double m = 1 / mainWindow->maxLD();
-    const double c = mainWindow->minDrag();
-    const double a = m * m / (4 * c);
+    params.c = mainWindow->minDrag();
+    params.a = m * m / (4 * params.c);
 
-    const int workingSize    = 100;     // Working population
-    const int keepSize       = 10;      // Number of elites to keep
-    const int newSize        = 10;      // New genomes in first level
-    const int numGenerations = 250;     // Generations per level of detail
-    const int tournamentSize = 5;       // Number of individuals in a tournament
-    const int mutationRate   = 100;     // Frequency of mutations
-    const int truncationRate = 10;      // Frequency of truncations
+    params.planformArea = mainWindow->planformArea();
+    params.mass = mainWindow->mass();
+    params.windowBottom = windowBottom;
+    params.integrationTolerance = integrationTolerance;
 
-    qsrand(QTime::currentTime().msec());
+    params.minLift = mainWindow->minLift();
+    params.maxLift = mainWindow->maxLift();
 
-    const double dt = 0.25; // Time step (s)
+    // Move to the next level once the best score stops improving
+    params.maxGenerations   = 250;
+    params.stallGenerations = 30;
+    params.tolerance        = 1e-4;
+
+    // Then polish the result with a gradient-based local search
+    params.polishIterations = 20;
+
+    // A seed of zero picks a different run each time
+    params.seed = mainWindow->optimizationSeed();
+    if (params.seed == 0) params.seed = QDateTime::currentMSecsSinceEpoch();
+
+    params.dt = 0.25;
 
     int kLim = 0;
-    while (dt * (1 << kLim) < mainWindow->simulationTime())
+    while (params.dt * (1 << kLim) < mainWindow->simulationTime())
     {
         ++kLim;
     }
 
-    const int genomeSize = (1 << kLim) + 1;
-    const int kMin = kLim - 4;
-    const int kMax = kLim - 2;
+    params.genomeSize = (1 << kLim) + 1;
+    params.kMin = kLim - 4;
+    params.kMax = kLim - 2;
+
+    return params;
+}
 
-    GenePool genePool;
+} // namespace
 
-    QProgressDialog progress("Initializing...",
-                             "Abort",
-                             0,
-                             (kMax - kMin + 1) * numGenerations * workingSize + workingSize,
-                             mainWindow);
-    progress.setWindowModality(Qt::WindowModal);
+ScoringMethod::ScoringMethod(QObject *parent) :
+    QObject(parent),
+    mIntegrationTolerance(0)
+{
 
-    double maxScore = 0;
-    bool abort = false;
+}
 
-    // Add new individuals
-    for (int i = 0; i < workingSize; ++i)
+void ScoringMethod::optimize(
+        MainWindow *mainWindow,
+        double windowBottom)
+{
+    if (activeDialog)
     {
-        progress.setValue(progress.value() + 1);
-        if (progress.wasCanceled())
-        {
-            abort = true;
-            break;
-        }
-
-        Genome g(genomeSize, kMin, mainWindow->minLift(), mainWindow->maxLift());
-        const MainWindow::DataPoints result = g.simulate(dt, a, c, mainWindow->planformArea(), mainWindow->mass(), dp0, windowBottom);
-        const double s = score(result);
-        genePool.append(Score(s, g));
-
-        maxScore = qMax(maxScore, s);
+        activeDialog->raise();
+        activeDialog->activateWindow();
+        return;
     }
 
-    // Increasing levels of detail
-    for (int k = kMin; k <= kMax && !abort; ++k)
+    const Optimizer::Parameters params =
+            parameters(mainWindow, mainWindow->data(), windowBottom, mIntegrationTolerance);
+
+    // Run in the background, updating the optimal track as it improves
+    Optimizer *optimizer = Optimizer::create(mainWindow->optimizationEngine());
+    OptimizationWorker *worker = new OptimizationWorker(this, optimizer, params);
+
+    activeDialog = new OptimizationDialog(this, worker, mainWindow);
+    connect(activeDialog, SIGNAL(bestTrajectoryChanged(MainWindow::DataPoints)),
+            mainWindow, SLOT(setOptimal(MainWindow::DataPoints)));
+
+    // Results only apply to the track and scoring setup they started with
+    connect(mainWindow, SIGNAL(dataLoaded()),
+            activeDialog, SLOT(abandon()));
+    connect(mainWindow, SIGNAL(scoringModeChanged()),
+            activeDialog, SLOT(abandon()));
+    connect(this, SIGNAL(scoringChanged()),
+            activeDialog, SLOT(abandon()));
+
+    // dataChanged also fires for view changes, so only abandon the run if
+    // the simulation itself is affected
+    activeMethod = this;
+    activeMainWindow = mainWindow;
+    activeParams = params;
+    connect(mainWindow, SIGNAL(dataChanged()),
+            this, SLOT(checkOptimization()), Qt::UniqueConnection);
+
+    activeDialog->start();
+}
+
+void ScoringMethod::checkOptimization()
+{
+    if (!activeDialog || activeMethod != this) return;
+
+    const Optimizer::Parameters params =
+            parameters(activeMainWindow, activeMainWindow->data(),
+                       activeParams.windowBottom, activeParams.integrationTolerance);
+
+    if (Optimizer::parametersKey(params) != Optimizer::parametersKey(activeParams)
+            || params.genomeSize != activeParams.genomeSize
+            || params.minLift != activeParams.minLift
+            || params.maxLift != activeParams.maxLift)
     {
-        // Generations
-        for (int j = 0; j < numGenerations && !abort; ++j)
-        {
-            progress.setValue(progress.value() + keepSize);
-            if (progress.wasCanceled())
-            {
-                abort = true;
-                break;
-            }
-
-            // Sort gene pool by score
-            qSort(genePool);
-
-            // Elitism
-            GenePool newGenePool = genePool.mid(0, keepSize);
-
-            // Initialize score
-            maxScore = 0;
-            for (int i = 0; i < keepSize; ++i)
-            {
-                maxScore = qMax(maxScore, newGenePool[i].first);
-            }
-
-            // Add new individuals in first level
-            for (int i = 0; k == kMin && i < newSize; ++i)
-            {
-                progress.setValue(progress.value() + 1);
-                if (progress.wasCanceled())
-                {
-                    abort = true;
-                    break;
-                }
-
-                Genome g(genomeSize, kMin, mainWindow->minLift(), mainWindow->maxLift());
-                const MainWindow::DataPoints result = g.simulate(dt, a, c, mainWindow->planformArea(), mainWindow->mass(), dp0, windowBottom);
-                const double s = score(result);
-                newGenePool.append(Score(s, g));
-
-                maxScore = qMax(maxScore, s);
-            }
-
-            // Tournament selection
-            while (newGenePool.size() < workingSize)
-            {
-                progress.setValue(progress.value() + 1);
-                if (progress.wasCanceled())
-                {
-                    abort = true;
-                    break;
-                }
-
-                const Genome &p1 = selectGenome(genePool, tournamentSize);
-                const Genome &p2 = selectGenome(genePool, tournamentSize);
-                Genome g(p1, p2, k);
-
-                if (qrand() % 100 < truncationRate)
-                {
-                    g.truncate(k);
-                }
-                if (qrand() % 100 < mutationRate)
-                {
-                    g.mutate(k, kMin, mainWindow->minLift(), mainWindow->maxLift());
-                }
-
-                const MainWindow::DataPoints result = g.simulate(dt, a, c, mainWindow->planformArea(), mainWindow->mass(), dp0, windowBottom);
-                const double s = score(result);
-                newGenePool.append(Score(s, g));
-
-                maxScore = qMax(maxScore, s);
-            }
-
-            genePool = newGenePool;
-
-            // Show best score in progress dialog
-            QString labelText = scoreAsText(maxScore);
-            progress.setLabelText(QString("Optimizing (best score is ") +
-                                  labelText +
-                                  QString(")..."));
-        }
+        activeDialog->abandon();
     }
+}
 
-    progress.setValue((kMax - kMin + 1) * numGenerations * workingSize + workingSize);
+void ScoringMethod::optimizeAll(
+        MainWindow *mainWindow,
+        double windowBottom)
+{
+    if (activeBatchDialog)
+    {
+        activeBatchDialog->raise();
+        activeBatchDialog->activateWindow();
+        return;
+    }
 
-    // Sort gene pool by score
-    qSort(genePool);
+    const QMap< QString, MainWindow::DataPoints > tracks = mainWindow->optimizationTracks();
 
-    // Keep most fit individual
-    mainWindow->setOptimal(genePool[0].second.simulate(dt, a, c, mainWindow->planformArea(), mainWindow->mass(), dp0, windowBottom));
+    QVector< BatchOptimizationWorker::Job > jobs;
+    QMap< QString, MainWindow::DataPoints >::const_iterator p;
+    for (p = tracks.constBegin(); p != tracks.constEnd(); ++p)
+    {
+        if (p.value().isEmpty()) continue;
+
+        BatchOptimizationWorker::Job job;
+        job.trackName = p.key();
+        job.data = p.value();
+        job.params = parameters(mainWindow, job.data, windowBottom, mIntegrationTolerance);
+        jobs.append(job);
+    }
+
+    if (jobs.isEmpty())
+    {
+        QMessageBox::information(mainWindow, tr("Optimize All"),
+                                 tr("Check or select the tracks to optimize in the logbook."));
+        return;
+    }
+
+    BatchOptimizationWorker *worker =
+            new BatchOptimizationWorker(this, mainWindow->optimizationEngine(), jobs);
+
+    activeBatchDialog = new BatchOptimizationDialog(
+                this, mainWindow, mainWindow->scoringMode(), worker, mainWindow);
+    activeBatchDialog->start();
 }
 
-const Genome &ScoringMethod::selectGenome(
-        const GenePool &genePool,
-        const int tournamentSize)
+void ScoringMethod::stopOptimizations()
 {
-    int jMax;
-    double sMax;
-    bool first = true;
+    if (activeDialog)
+    {
+        activeDialog->stop();
+    }
 
-    for (int i = 0; i < tournamentSize; ++i)
+    if (activeBatchDialog)
     {
-        const int j = qrand() % genePool.size();
-        if (first || genePool[j].first > sMax)
-        {
-            jMax = j;
-            sMax = genePool[j].first;
-            first = false;
-        }
+        activeBatchDialog->stop();
     }
+}
 
-    return genePool[jMax].second;
+void ScoringMethod::readIntegrationTolerance(
+        QSettings &settings)
+{
+    mIntegrationTolerance = settings.value("integrationTolerance", mIntegrationTolerance).toDouble();
+}
+
+void ScoringMethod::writeIntegrationTolerance(
+        QSettings &settings) const
+{
+    settings.setValue("integrationTolerance", mIntegrationTolerance);
 }
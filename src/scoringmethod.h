@@ -34,6 +34,7 @@
 class DataPlot;
 class MainWindow;
 class MapView;
+class QSettings;
 
 typedef QPair< double, Genome > Score;
 typedef QVector< Score > GenePool;
@@ -49,6 +50,8 @@ class ScoringMethod : public QObject
 public:
     explicit ScoringMethod(QObject *parent = 0);
 
+    // Called concurrently from worker threads during optimization, so it
+    // must not modify any state
     virtual double score(const MainWindow::DataPoints &result) { return 0; }
     virtual QString scoreAsText(double score) { return QString(); }
 
@@ -60,19 +63,41 @@ public:
 
     virtual void optimize() {}
 
+    // Optimizes every checked (or selected) track in turn and shows a
+    // summary of actual against optimal scores
+    virtual void optimizeAll() {}
+
+    // Stops any optimization still running, waiting for its worker
+    // threads. Call before the scoring methods are destroyed.
+    static void stopOptimizations();
+
+    // Error tolerance for adaptive integration while optimizing, or zero
+    // to use fixed steps
+    double integrationTolerance() const { return mIntegrationTolerance; }
+    void setIntegrationTolerance(double tolerance) { mIntegrationTolerance = tolerance; }
+
     virtual void readSettings() {}
     virtual void writeSettings() {}
 
 protected:
     void optimize(MainWindow *mainWindow, double windowBottom);
+    void optimizeAll(MainWindow *mainWindow, double windowBottom);
+
+    // Called from readSettings and writeSettings inside the method's own
+    // settings group
+    void readIntegrationTolerance(QSettings &settings);
+    void writeIntegrationTolerance(QSettings &settings) const;
 
 private:
-    const Genome &selectGenome(const GenePool &genePool, const int tournamentSize);
+    double mIntegrationTolerance;
 
 signals:
     void scoringChanged();
 
 public slots:
+
+private slots:
+    void checkOptimization();
 };
 
 #endif // SCORINGMETHOD_H
@@ -0,0 +1,135 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include <QVector>
+
+#include "slopefilter.h"
+
+// Window sums are rebuilt from scratch at this interval, relative to a new
+// time origin, so rounding error from the running updates cannot build up
+// over long tracks
+#define RESYNC_INTERVAL 256
+
+SlopeFilter::SlopeFilter(
+        int halfWidth):
+    mHalfWidth(qMax(1, halfWidth))
+{
+
+}
+
+void SlopeFilter::setHalfWidth(
+        int halfWidth)
+{
+    mHalfWidth = qMax(1, halfWidth);
+}
+
+void SlopeFilter::apply(
+        const double *t,
+        int size,
+        int channels,
+        const double * const *in,
+        double * const *out) const
+{
+    if (size <= 0 || channels <= 0) return;
+
+    QVector< double > sumyBuf(channels), sumxyBuf(channels);
+    double *sumy = sumyBuf.data();
+    double *sumxy = sumxyBuf.data();
+
+    double origin = 0, sumx = 0, sumxx = 0;
+    int iMin = 0, iMax = -1;
+
+    for (int i = 0; i < size; ++i)
+    {
+        const int lower = qMax(0, i - mHalfWidth);
+        const int upper = qMin(size - 1, i + mHalfWidth);
+
+        if (i % RESYNC_INTERVAL == 0)
+        {
+            origin = t[i];
+            sumx = sumxx = 0;
+
+            for (int c = 0; c < channels; ++c)
+            {
+                sumy[c] = sumxy[c] = 0;
+            }
+
+            for (int j = lower; j <= upper; ++j)
+            {
+                const double x = t[j] - origin;
+
+                sumx += x;
+                sumxx += x * x;
+
+                for (int c = 0; c < channels; ++c)
+                {
+                    sumy[c] += in[c][j];
+                    sumxy[c] += x * in[c][j];
+                }
+            }
+        }
+        else
+        {
+            // Window advances by at most one sample at each end
+            if (iMin < lower)
+            {
+                const double x = t[iMin] - origin;
+
+                sumx -= x;
+                sumxx -= x * x;
+
+                for (int c = 0; c < channels; ++c)
+                {
+                    sumy[c] -= in[c][iMin];
+                    sumxy[c] -= x * in[c][iMin];
+                }
+            }
+
+            if (iMax < upper)
+            {
+                const double x = t[upper] - origin;
+
+                sumx += x;
+                sumxx += x * x;
+
+                for (int c = 0; c < channels; ++c)
+                {
+                    sumy[c] += in[c][upper];
+                    sumxy[c] += x * in[c][upper];
+                }
+            }
+        }
+
+        iMin = lower;
+        iMax = upper;
+
+        const int n = upper - lower + 1;
+        const double den = sumxx - sumx * sumx / n;
+
+        for (int c = 0; c < channels; ++c)
+        {
+            out[c][i] = (sumxy[c] - sumx * sumy[c] / n) / den;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef SLOPEFILTER_H
+#define SLOPEFILTER_H
+
+class SlopeFilter
+{
+public:
+    explicit SlopeFilter(int halfWidth = 4);
+
+    void setHalfWidth(int halfWidth);
+    int halfWidth() const { return mHalfWidth; }
+
+    // Least-squares slope of each input channel against t, taken over a
+    // window of up to 2 * halfWidth + 1 samples centred on each sample.
+    // The window is clipped at the ends of the track.
+    void apply(const double *t, int size, int channels,
+               const double * const *in, double * const *out) const;
+
+private:
+    int mHalfWidth;
+};
+
+#endif // SLOPEFILTER_H
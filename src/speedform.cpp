@@ -48,6 +48,13 @@ SpeedForm::SpeedForm(QWidget *parent) :
     connect(ui->actualButton, SIGNAL(clicked()), this, SLOT(onActualButtonClicked()));
     connect(ui->optimalButton, SIGNAL(clicked()), this, SLOT(onOptimalButtonClicked()));
     connect(ui->optimizeButton, SIGNAL(clicked()), this, SLOT(onOptimizeButtonClicked()));
+    connect(ui->optimizeAllButton, SIGNAL(clicked()), this, SLOT(onOptimizeAllButtonClicked()));
+
+    // Optimization engines in MainWindow::OptimizationEngine order
+    ui->engineComboBox->addItem(tr("Genetic algorithm"));
+    ui->engineComboBox->addItem(tr("Differential evolution"));
+    connect(ui->engineComboBox, SIGNAL(activated(int)), this, SLOT(onEngineChanged(int)));
+    connect(ui->toleranceEdit, SIGNAL(editingFinished()), this, SLOT(onToleranceChanged()));
 
     // Connect PPC button
     connect(ui->ppcButton, SIGNAL(clicked()), this, SLOT(onPpcButtonClicked()));
@@ -68,6 +75,10 @@ void SpeedForm::setMainWindow(
         MainWindow *mainWindow)
 {
     mMainWindow = mainWindow;
+
+    // The engine is shared by all forms, so follow changes made elsewhere
+    connect(mMainWindow, SIGNAL(optimizationEngineChanged()),
+            this, SLOT(updateEngine()));
 }
 
 void SpeedForm::updateView()
@@ -75,6 +86,9 @@ void SpeedForm::updateView()
     // Update mode selection
     ui->actualButton->setChecked(mMainWindow->windowMode() == MainWindow::Actual);
     ui->optimalButton->setChecked(mMainWindow->windowMode() == MainWindow::Optimal);
+    updateEngine();
+    ui->toleranceEdit->setText(QString("%1").arg(
+                                   mMainWindow->scoringMethod(MainWindow::Speed)->integrationTolerance()));
 
     SpeedScoring *method = (SpeedScoring *) mMainWindow->scoringMethod(MainWindow::Speed);
 
@@ -203,6 +217,37 @@ void SpeedForm::onOptimizeButtonClicked()
     mMainWindow->setWindowMode(MainWindow::Optimal);
 }
 
+void SpeedForm::onOptimizeAllButtonClicked()
+{
+    SpeedScoring *method = (SpeedScoring *) mMainWindow->scoringMethod(MainWindow::Speed);
+    method->optimizeAll();
+}
+
+void SpeedForm::updateEngine()
+{
+    ui->engineComboBox->setCurrentIndex(mMainWindow->optimizationEngine());
+}
+
+void SpeedForm::onEngineChanged(
+        int index)
+{
+    mMainWindow->setOptimizationEngine((MainWindow::OptimizationEngine) index);
+}
+
+void SpeedForm::onToleranceChanged()
+{
+    // Zero selects fixed RK4 steps
+    double tolerance = ui->toleranceEdit->text().toDouble();
+    if (tolerance < 0) tolerance = 0;
+
+    SpeedScoring *method = (SpeedScoring *) mMainWindow->scoringMethod(MainWindow::Speed);
+    method->setIntegrationTolerance(tolerance);
+
+    ui->toleranceEdit->setText(QString("%1").arg(tolerance));
+
+    mMainWindow->setFocus();
+}
+
 void SpeedForm::onPpcButtonClicked() {
 
     // Return if plot empty
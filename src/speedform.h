@@ -55,6 +55,7 @@ private:
 
 public slots:
     void updateView();
+    void updateEngine();
 
 private slots:
     void onFAIButtonClicked();
@@ -65,6 +66,9 @@ private slots:
     void onActualButtonClicked();
     void onOptimalButtonClicked();
     void onOptimizeButtonClicked();
+    void onOptimizeAllButtonClicked();
+    void onEngineChanged(int index);
+    void onToleranceChanged();
 
     void onPpcButtonClicked();
 };
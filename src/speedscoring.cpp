@@ -23,6 +23,8 @@
 
 #include "speedscoring.h"
 
+#include <QSettings>
+
 #include "mainwindow.h"
 
 #define TIME_DELTA 0.005
@@ -189,3 +191,21 @@ bool SpeedScoring::getWindowBounds(
 
     return found;
 }
+
+void SpeedScoring::readSettings()
+{
+    QSettings settings("FlySight", "Viewer");
+
+    settings.beginGroup("speedScoring");
+        readIntegrationTolerance(settings);
+    settings.endGroup();
+}
+
+void SpeedScoring::writeSettings()
+{
+    QSettings settings("FlySight", "Viewer");
+
+    settings.beginGroup("speedScoring");
+        writeIntegrationTolerance(settings);
+    settings.endGroup();
+}
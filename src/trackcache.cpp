@@ -0,0 +1,167 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include <QFile>
+#include <QSaveFile>
+
+#include <string.h>
+
+#include "trackcache.h"
+#include "trackdata.h"
+
+// File layout: header, then timestamps (qint64), then one array of
+// doubles per TrackData channel, then hasGeodetic flags (one byte each)
+
+#define CACHE_MAGIC   0x43545346    // "FSTC"
+#define CACHE_VERSION 1
+
+TrackCache::Header TrackCache::header(
+        const TrackProcessor::Parameters &params,
+        int halfWidth,
+        int count)
+{
+    Header h;
+    memset(&h, 0, sizeof(h));
+
+    h.magic = CACHE_MAGIC;
+    h.version = CACHE_VERSION;
+    h.count = count;
+    h.channels = TrackData::chLast;
+
+    h.exit = params.exit;
+    h.halfWidth = halfWidth;
+    h.windAdjustment = params.windAdjustment;
+    h.ground = params.ground;
+    h.windE = params.windE;
+    h.windN = params.windN;
+    h.course = params.course;
+    h.mass = params.mass;
+    h.planformArea = params.planformArea;
+
+    return h;
+}
+
+qint64 TrackCache::fileSize(
+        quint32 count)
+{
+    return sizeof(Header)
+            + (qint64) count * sizeof(qint64)
+            + (qint64) count * TrackData::chLast * sizeof(double)
+            + (qint64) count;
+}
+
+bool TrackCache::read(
+        const QString &fileName,
+        const TrackProcessor::Parameters &params,
+        int halfWidth,
+        QVector< DataPoint > &data)
+{
+    // Only tracks with known ground and exit can be matched
+    if (!params.hasGround || !params.hasExit) return false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 size = file.size();
+    if (size < (qint64) sizeof(Header)) return false;
+
+    uchar *map = file.map(0, size);
+    if (!map) return false;
+
+    Header h;
+    memcpy(&h, map, sizeof(h));
+
+    const Header expected = header(params, halfWidth, h.count);
+
+    // Validate header and size
+    if (memcmp(&h, &expected, sizeof(h)) != 0 || size != fileSize(h.count))
+    {
+        file.unmap(map);
+        return false;
+    }
+
+    const int count = h.count;
+
+    const qint64 *timestamp = (const qint64 *) (map + sizeof(Header));
+    const double *channels = (const double *) (timestamp + count);
+    const uchar *hasGeodetic = (const uchar *) (channels + count * TrackData::chLast);
+
+    data.resize(count);
+
+    double values[TrackData::chLast];
+
+    for (int i = 0; i < count; ++i)
+    {
+        DataPoint &dp = data[i];
+
+        dp.timestamp = timestamp[i];
+        dp.hasGeodetic = hasGeodetic[i];
+
+        for (int c = 0; c < TrackData::chLast; ++c)
+        {
+            values[c] = channels[c * count + i];
+        }
+
+        TrackData::setChannels(dp, values);
+    }
+
+    file.unmap(map);
+    return true;
+}
+
+bool TrackCache::write(
+        const QString &fileName,
+        const TrackProcessor::Parameters &params,
+        int halfWidth,
+        const QVector< DataPoint > &data)
+{
+    if (!params.hasGround || !params.hasExit) return false;
+
+    const TrackData track(data);
+    const Header h = header(params, halfWidth, track.size());
+
+    QByteArray hasGeodetic(track.size(), 0);
+    for (int i = 0; i < track.size(); ++i)
+    {
+        hasGeodetic[i] = data[i].hasGeodetic;
+    }
+
+    // Replace any old file atomically
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    file.write((const char *) &h, sizeof(h));
+    file.write((const char *) track.timestamp().constData(),
+               track.size() * sizeof(qint64));
+
+    for (int c = 0; c < TrackData::chLast; ++c)
+    {
+        file.write((const char *) track.constData((TrackData::Channel) c),
+                   track.size() * sizeof(double));
+    }
+
+    file.write(hasGeodetic);
+
+    return file.commit();
+}
@@ -0,0 +1,71 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef TRACKCACHE_H
+#define TRACKCACHE_H
+
+#include <QString>
+#include <QVector>
+
+#include "datapoint.h"
+#include "trackprocessor.h"
+
+class TrackCache
+{
+public:
+    // Read a processed track. Fails if the file is missing, damaged, or
+    // was written with different processing parameters.
+    static bool read(const QString &fileName,
+                     const TrackProcessor::Parameters &params, int halfWidth,
+                     QVector< DataPoint > &data);
+
+    static bool write(const QString &fileName,
+                      const TrackProcessor::Parameters &params, int halfWidth,
+                      const QVector< DataPoint > &data);
+
+private:
+    typedef struct {
+        quint32 magic;
+        quint32 version;
+        quint32 count;
+        quint32 channels;
+
+        // Parameter fingerprint
+        qint64  exit;
+        qint32  halfWidth;
+        qint32  windAdjustment;
+        double  ground;
+        double  windE;
+        double  windN;
+        double  course;
+        double  mass;
+        double  planformArea;
+    } Header;
+
+    static Header header(const TrackProcessor::Parameters &params,
+                         int halfWidth, int count);
+    static qint64 fileSize(quint32 count);
+};
+
+#endif // TRACKCACHE_H
@@ -0,0 +1,174 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include "trackdata.h"
+
+TrackData::TrackData():
+    mSize(0)
+{
+
+}
+
+TrackData::TrackData(
+        const QVector< DataPoint > &data):
+    mSize(0)
+{
+    assign(data);
+}
+
+void TrackData::assign(
+        const QVector< DataPoint > &data)
+{
+    mSize = data.size();
+
+    mTimestamp.resize(mSize);
+    mHasGeodetic.resize(mSize);
+
+    double *ch[chLast];
+    for (int c = 0; c < chLast; ++c)
+    {
+        mChannels[c].resize(mSize);
+        ch[c] = mChannels[c].data();
+    }
+
+    double values[chLast];
+
+    for (int i = 0; i < mSize; ++i)
+    {
+        const DataPoint &dp = data[i];
+
+        mTimestamp[i] = dp.timestamp;
+        mHasGeodetic[i] = dp.hasGeodetic;
+
+        getChannels(dp, values);
+        for (int c = 0; c < chLast; ++c)
+        {
+            ch[c][i] = values[c];
+        }
+    }
+}
+
+void TrackData::clear()
+{
+    mSize = 0;
+
+    mTimestamp.clear();
+    mHasGeodetic.clear();
+
+    for (int c = 0; c < chLast; ++c)
+    {
+        mChannels[c].clear();
+    }
+}
+
+DataPoint TrackData::row(
+        int i) const
+{
+    DataPoint dp;
+
+    dp.timestamp   = mTimestamp[i];
+    dp.hasGeodetic = mHasGeodetic[i];
+
+    double values[chLast];
+    for (int c = 0; c < chLast; ++c)
+    {
+        values[c] = mChannels[c][i];
+    }
+
+    setChannels(dp, values);
+
+    return dp;
+}
+
+void TrackData::getChannels(
+        const DataPoint &dp,
+        double *values)
+{
+    values[T]       = dp.t;
+    values[Lat]     = dp.lat;
+    values[Lon]     = dp.lon;
+    values[HMSL]    = dp.hMSL;
+    values[VelN]    = dp.velN;
+    values[VelE]    = dp.velE;
+    values[VelD]    = dp.velD;
+    values[HAcc]    = dp.hAcc;
+    values[VAcc]    = dp.vAcc;
+    values[SAcc]    = dp.sAcc;
+    values[Heading] = dp.heading;
+    values[CAcc]    = dp.cAcc;
+    values[NumSV]   = dp.numSV;
+    values[X]       = dp.x;
+    values[Y]       = dp.y;
+    values[Z]       = dp.z;
+    values[Dist2D]  = dp.dist2D;
+    values[Dist3D]  = dp.dist3D;
+    values[Curv]    = dp.curv;
+    values[Accel]   = dp.accel;
+    values[AX]      = dp.ax;
+    values[AY]      = dp.ay;
+    values[AZ]      = dp.az;
+    values[AMag]    = dp.amag;
+    values[Lift]    = dp.lift;
+    values[Drag]    = dp.drag;
+    values[VX]      = dp.vx;
+    values[VY]      = dp.vy;
+    values[Theta]   = dp.theta;
+    values[Omega]   = dp.omega;
+}
+
+void TrackData::setChannels(
+        DataPoint &dp,
+        const double *values)
+{
+    dp.t       = values[T];
+    dp.lat     = values[Lat];
+    dp.lon     = values[Lon];
+    dp.hMSL    = values[HMSL];
+    dp.velN    = values[VelN];
+    dp.velE    = values[VelE];
+    dp.velD    = values[VelD];
+    dp.hAcc    = values[HAcc];
+    dp.vAcc    = values[VAcc];
+    dp.sAcc    = values[SAcc];
+    dp.heading = values[Heading];
+    dp.cAcc    = values[CAcc];
+    dp.numSV   = values[NumSV];
+    dp.x       = values[X];
+    dp.y       = values[Y];
+    dp.z       = values[Z];
+    dp.dist2D  = values[Dist2D];
+    dp.dist3D  = values[Dist3D];
+    dp.curv    = values[Curv];
+    dp.accel   = values[Accel];
+    dp.ax      = values[AX];
+    dp.ay      = values[AY];
+    dp.az      = values[AZ];
+    dp.amag    = values[AMag];
+    dp.lift    = values[Lift];
+    dp.drag    = values[Drag];
+    dp.vx      = values[VX];
+    dp.vy      = values[VY];
+    dp.theta   = values[Theta];
+    dp.omega   = values[Omega];
+}
@@ -0,0 +1,99 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef TRACKDATA_H
+#define TRACKDATA_H
+
+#include <QVector>
+
+#include "datapoint.h"
+
+class TrackData
+{
+public:
+    typedef enum {
+        T = 0,
+        Lat,
+        Lon,
+        HMSL,
+        VelN,
+        VelE,
+        VelD,
+        HAcc,
+        VAcc,
+        SAcc,
+        Heading,
+        CAcc,
+        NumSV,
+        X,
+        Y,
+        Z,
+        Dist2D,
+        Dist3D,
+        Curv,
+        Accel,
+        AX,
+        AY,
+        AZ,
+        AMag,
+        Lift,
+        Drag,
+        VX,
+        VY,
+        Theta,
+        Omega,
+        chLast
+    } Channel;
+
+    TrackData();
+    explicit TrackData(const QVector< DataPoint > &data);
+
+    void assign(const QVector< DataPoint > &data);
+    void clear();
+
+    int size() const { return mSize; }
+    bool isEmpty() const { return mSize == 0; }
+
+    // Contiguous samples for one channel
+    const QVector< double > &channel(Channel c) const { return mChannels[c]; }
+    const double *constData(Channel c) const { return mChannels[c].constData(); }
+
+    const QVector< qint64 > &timestamp() const { return mTimestamp; }
+
+    // Row view for code which works with whole samples
+    DataPoint row(int i) const;
+
+    // Convert between a sample and its channel values
+    static void getChannels(const DataPoint &dp, double *values);
+    static void setChannels(DataPoint &dp, const double *values);
+
+private:
+    int                  mSize;
+
+    QVector< qint64 >    mTimestamp;
+    QVector< bool >      mHasGeodetic;
+    QVector< double >    mChannels[chLast];
+};
+
+#endif // TRACKDATA_H
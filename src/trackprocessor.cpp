@@ -0,0 +1,514 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#include <math.h>
+
+#include "GeographicLib/Geodesic.hpp"
+
+#include "atmosphere.h"
+#include "common.h"
+#include "trackprocessor.h"
+
+using namespace GeographicLib;
+
+TrackProcessor::TrackProcessor(
+        int halfWidth):
+    mSlopeFilter(halfWidth)
+{
+
+}
+
+void TrackProcessor::process(
+        DataPoints &data,
+        Parameters &params) const
+{
+    if (data.isEmpty()) return;
+
+    // Initialize time
+    initTime(data, data.first().timestamp);
+
+    // Altitude above ground
+    if (!params.hasGround)
+    {
+        params.ground = data.last().hMSL;
+        params.hasGround = true;
+    }
+
+    updateGround(data, params.ground);
+
+    // Raw acceleration
+    initAcceleration(data);
+
+    // Pick exit
+    if (!params.hasExit)
+    {
+        params.exit = findExit(data);
+        params.hasExit = true;
+    }
+
+    initTime(data, params.exit);
+
+    // Wind adjustments
+    updateVelocity(data, params);
+}
+
+void TrackProcessor::initTime(
+        DataPoints &data,
+        qint64 start)
+{
+    for (int i = 0; i < data.size(); ++i)
+    {
+        DataPoint &dp = data[i];
+        dp.t = (double) (dp.timestamp - start) / 1000;
+    }
+}
+
+qint64 TrackProcessor::findExit(
+        const DataPoints &data)
+{
+    for (int i = 1; i < data.size(); ++i)
+    {
+        const DataPoint &dp1 = data[i - 1];
+        const DataPoint &dp2 = data[i];
+
+        // Get interpolation coefficient
+        const double velD = A_GRAVITY;
+        const double a = (velD - dp1.velD) / (dp2.velD - dp1.velD);
+
+        // Check vertical speed
+        if (a < 0 || 1 < a) continue;
+
+        // Check accuracy
+        const double vAcc = dp1.vAcc + a * (dp2.vAcc - dp1.vAcc);
+        if (vAcc > 10) continue;
+
+        // Check acceleration
+        const double az = dp1.az + a * (dp2.az - dp1.az);
+        if (az < A_GRAVITY / 5.) continue;
+
+        // Determine exit
+        const qint64 t1 = dp1.timestamp;
+        const qint64 t2 = dp2.timestamp;
+        return t1 + a * (t2 - t1) - velD / az * 1000.;
+    }
+
+    return data.first().timestamp;
+}
+
+void TrackProcessor::updateGround(
+        DataPoints &data,
+        double ground)
+{
+    for (int i = 0; i < data.size(); ++i)
+    {
+        DataPoint &dp = data[i];
+        dp.z = dp.hMSL - ground;
+    }
+}
+
+void TrackProcessor::initAcceleration(
+        DataPoints &data) const
+{
+    double (* const values[])(const DataPoint &) = {
+        DataPoint::northSpeedRaw,
+        DataPoint::eastSpeedRaw,
+        DataPoint::verticalSpeed
+    };
+
+    QVector< double > slopes[3];
+    getSlopes(data, 3, values, slopes);
+
+    for (int i = 0; i < data.size(); ++i)
+    {
+        DataPoint &dp = data[i];
+
+        // Acceleration
+        double accelN = slopes[0][i];
+        double accelE = slopes[1][i];
+        double accelD = slopes[2][i];
+
+        // Calculate acceleration in direction of flight
+        const double vh = sqrt(dp.velN * dp.velN + dp.velE * dp.velE);
+        dp.ax = (accelN * dp.velN + accelE * dp.velE) / vh;
+
+        // Calculate acceleration perpendicular to flight
+        dp.ay = (accelE * dp.velN - accelN * dp.velE) / vh;
+
+        // Calculate vertical acceleration
+        dp.az = accelD;
+
+        // Calculate total acceleration
+        dp.amag = sqrt(accelN * accelN + accelE * accelE + accelD * accelD);
+    }
+}
+
+void TrackProcessor::updateVelocity(
+        DataPoints &data,
+        const Parameters &params) const
+{
+    if (data.isEmpty()) return;
+
+    const DataPoint dpExit = interpolateDataT(data, 0);
+
+    if (params.windAdjustment)
+    {
+        // Wind-adjusted position
+        for (int i = 0; i < data.size(); ++i)
+        {
+            DataPoint &dp = data[i];
+
+            double distance = getDistance(dpExit, dp, true);
+            double bearing = getBearing(dpExit, dp, true);
+
+            dp.x = distance * sin(bearing) - params.windE * dp.t;
+            dp.y = distance * cos(bearing) - params.windN * dp.t;
+        }
+
+        // Wind-adjusted velocity
+        for (int i = 0; i < data.size(); ++i)
+        {
+            DataPoint &dp = data[i];
+
+            dp.vx = dp.velE - params.windE;
+            dp.vy = dp.velN - params.windN;
+        }
+    }
+    else
+    {
+        // Unadjusted position
+        for (int i = 0; i < data.size(); ++i)
+        {
+            DataPoint &dp = data[i];
+
+            double distance = getDistance(dpExit, dp, false);
+            double bearing = getBearing(dpExit, dp, false);
+
+            dp.x = distance * sin(bearing);
+            dp.y = distance * cos(bearing);
+        }
+
+        // Unadjusted velocity
+        for (int i = 0; i < data.size(); ++i)
+        {
+            DataPoint &dp = data[i];
+
+            dp.vx = dp.velE;
+            dp.vy = dp.velN;
+        }
+    }
+
+    // Distance measurements
+    double dist2D = 0, dist3D = 0;
+
+    for (int i = 0; i < data.size(); ++i)
+    {
+        DataPoint &dp = data[i];
+
+        if (i > 0)
+        {
+            const DataPoint &dpPrev = data[i - 1];
+
+            double dx = dp.x - dpPrev.x;
+            double dy = dp.y - dpPrev.y;
+            double dh = sqrt(dx * dx + dy * dy);
+            double dz = dp.hMSL - dpPrev.hMSL;
+
+            dist2D += dh;
+            dist3D += sqrt(dh * dh + dz * dz);
+        }
+
+        dp.dist2D = dist2D;
+        dp.dist3D = dist3D;
+    }
+
+    // Adjust for exit
+    DataPoint dp0 = interpolateDataT(data, 0);
+
+    for (int i = 0; i < data.size(); ++i)
+    {
+        DataPoint &dp = data[i];
+
+        dp.x -= dp0.x;
+        dp.y -= dp0.y;
+
+        dp.dist2D -= dp0.dist2D;
+        dp.dist3D -= dp0.dist3D;
+    }
+
+    // Cumulative heading
+    double prevHeading;
+    bool firstHeading = true;
+
+    for (int i = 0; i < data.size(); ++i)
+    {
+        DataPoint &dp = data[i];
+
+        // Calculate heading
+        dp.heading = atan2(dp.vx, dp.vy) / PI * 180;
+
+        // Calculate heading accuracy
+        const double s = DataPoint::totalSpeed(dp);
+        if (s != 0) dp.cAcc = dp.sAcc / s;
+        else        dp.cAcc = 0;
+
+        // Adjust heading
+        if (!firstHeading)
+        {
+            while (dp.heading <  prevHeading - 180) dp.heading += 360;
+            while (dp.heading >= prevHeading + 180) dp.heading -= 360;
+        }
+
+        // Relative heading
+        dp.theta = dp.heading - params.course;
+
+        firstHeading = false;
+        prevHeading = dp.heading;
+    }
+
+    // Parameters depending on velocity
+    double (* const values[])(const DataPoint &) = {
+        DataPoint::diveAngle,
+        DataPoint::totalSpeed,
+        DataPoint::course
+    };
+
+    QVector< double > slopes[3];
+    getSlopes(data, 3, values, slopes);
+
+    for (int i = 0; i < data.size(); ++i)
+    {
+        DataPoint &dp = data[i];
+
+        dp.curv = slopes[0][i];
+        dp.accel = slopes[1][i];
+        dp.omega = slopes[2][i];
+    }
+
+    // Initialize aerodynamics
+    updateAerodynamics(data, params);
+}
+
+void TrackProcessor::updateAerodynamics(
+        DataPoints &data,
+        const Parameters &params) const
+{
+    double (* const values[])(const DataPoint &) = {
+        DataPoint::northSpeed,
+        DataPoint::eastSpeed,
+        DataPoint::verticalSpeed
+    };
+
+    QVector< double > slopes[3];
+    getSlopes(data, 3, values, slopes);
+
+    const Atmosphere &atmosphere = Atmosphere::standard();
+
+    for (int i = 0; i < data.size(); ++i)
+    {
+        DataPoint &dp = data[i];
+
+        // Acceleration
+        double accelN = slopes[0][i];
+        double accelE = slopes[1][i];
+        double accelD = slopes[2][i];
+
+        // Subtract acceleration due to gravity
+        accelD -= A_GRAVITY;
+
+        // Calculate acceleration due to drag
+        const double vel = DataPoint::totalSpeed(dp);
+        const double proj = (accelN * dp.vy + accelE * dp.vx + accelD * dp.velD) / vel;
+
+        const double dragN = proj * dp.vy / vel;
+        const double dragE = proj * dp.vx / vel;
+        const double dragD = proj * dp.velD / vel;
+
+        const double accelDrag = sqrt(dragN * dragN + dragE * dragE + dragD * dragD);
+
+        // Calculate acceleration due to lift
+        const double liftN = accelN - dragN;
+        const double liftE = accelE - dragE;
+        const double liftD = accelD - dragD;
+
+        const double accelLift = sqrt(liftN * liftN + liftE * liftE + liftD * liftD);
+
+        const double airDensity = atmosphere.density(dp.hMSL);
+
+        // From https://en.wikipedia.org/wiki/Dynamic_pressure
+        const double dynamicPressure = airDensity * vel * vel / 2;
+
+        // Calculate lift and drag coefficients
+        dp.lift = params.mass * accelLift / dynamicPressure / params.planformArea;
+        dp.drag = params.mass * accelDrag / dynamicPressure / params.planformArea;
+    }
+}
+
+void TrackProcessor::getSlopes(
+        const DataPoints &data,
+        int channels,
+        double (* const *values)(const DataPoint &),
+        QVector< double > *slopes) const
+{
+    const int n = data.size();
+
+    // Gather time and inputs into contiguous arrays
+    QVector< double > t(n);
+    QVector< QVector< double > > in(channels);
+
+    QVector< const double * > inPtr(channels);
+    QVector< double * > outPtr(channels);
+
+    for (int c = 0; c < channels; ++c)
+    {
+        in[c].resize(n);
+        slopes[c].resize(n);
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        const DataPoint &dp = data[i];
+
+        t[i] = dp.t;
+        for (int c = 0; c < channels; ++c)
+        {
+            in[c][i] = values[c](dp);
+        }
+    }
+
+    for (int c = 0; c < channels; ++c)
+    {
+        inPtr[c] = in[c].constData();
+        outPtr[c] = slopes[c].data();
+    }
+
+    mSlopeFilter.apply(t.constData(), n, channels,
+                       inPtr.constData(), outPtr.constData());
+}
+
+DataPoint TrackProcessor::interpolateDataT(
+        const DataPoints &data,
+        double t)
+{
+    const int i1 = findIndexBelowT(data, t);
+    const int i2 = findIndexAboveT(data, t);
+
+    if (i1 < 0)
+    {
+        return data.first();
+    }
+    else if (i2 >= data.size())
+    {
+        return data.last();
+    }
+    else
+    {
+        const DataPoint &dp1 = data[i1];
+        const DataPoint &dp2 = data[i2];
+        return DataPoint::interpolate(dp1, dp2, (t - dp1.t) / (dp2.t - dp1.t));
+    }
+}
+
+int TrackProcessor::findIndexBelowT(
+        const DataPoints &data,
+        double t)
+{
+    int below = -1;
+    int above = data.size();
+
+    while (below + 1 != above)
+    {
+        int mid = (below + above) / 2;
+        const DataPoint &dp = data[mid];
+
+        if (dp.t < t) below = mid;
+        else          above = mid;
+    }
+
+    return below;
+}
+
+int TrackProcessor::findIndexAboveT(
+        const DataPoints &data,
+        double t)
+{
+    int below = -1;
+    int above = data.size();
+
+    while (below + 1 != above)
+    {
+        int mid = (below + above) / 2;
+        const DataPoint &dp = data[mid];
+
+        if (dp.t > t) above = mid;
+        else          below = mid;
+    }
+
+    return above;
+}
+
+double TrackProcessor::getDistance(
+        const DataPoint &dp1,
+        const DataPoint &dp2,
+        bool windAdjustment)
+{
+    if (!windAdjustment && dp1.hasGeodetic && dp2.hasGeodetic)
+    {
+        const Geodesic &geod = Geodesic::WGS84();
+        double s12;
+
+        geod.Inverse(dp1.lat, dp1.lon, dp2.lat, dp2.lon, s12);
+
+        return s12;
+    }
+    else
+    {
+        const double dx = dp2.x - dp1.x;
+        const double dy = dp2.y - dp1.y;
+
+        return sqrt(dx * dx + dy * dy);
+    }
+}
+
+double TrackProcessor::getBearing(
+        const DataPoint &dp1,
+        const DataPoint &dp2,
+        bool windAdjustment)
+{
+    if (!windAdjustment && dp1.hasGeodetic && dp2.hasGeodetic)
+    {
+        const Geodesic &geod = Geodesic::WGS84();
+        double azi1, azi2;
+
+        geod.Inverse(dp1.lat, dp1.lon, dp2.lat, dp2.lon, azi1, azi2);
+
+        return azi1 / 180 * PI;
+    }
+    else
+    {
+        const double dx = dp2.x - dp1.x;
+        const double dy = dp2.y - dp1.y;
+
+        return atan2(dx, dy);
+    }
+}
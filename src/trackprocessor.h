@@ -0,0 +1,86 @@
+/***************************************************************************
+**                                                                        **
+**  FlySight Viewer                                                       **
+**  Copyright 2018 Michael Cooper                                         **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>. **
+**                                                                        **
+****************************************************************************
+**  Contact: Michael Cooper                                               **
+**  Website: http://flysight.ca/                                          **
+****************************************************************************/
+
+
+#ifndef TRACKPROCESSOR_H
+#define TRACKPROCESSOR_H
+
+#include <QVector>
+
+#include "datapoint.h"
+#include "slopefilter.h"
+
+class TrackProcessor
+{
+public:
+    typedef QVector< DataPoint > DataPoints;
+
+    typedef struct {
+        bool   hasGround;       // Otherwise the last sample is used
+        double ground;          // Ground elevation above MSL (m)
+        bool   hasExit;         // Otherwise exit is detected from the track
+        qint64 exit;            // Exit time (UTC ms since epoch)
+        double windE;           // Wind velocity (m/s)
+        double windN;
+        bool   windAdjustment;  // Positions relative to the air mass
+        double course;          // Reference heading (deg)
+        double mass;            // Jumper mass (kg)
+        double planformArea;    // Planform area (m^2)
+    } Parameters;
+
+    explicit TrackProcessor(int halfWidth = 4);
+
+    void setHalfWidth(int halfWidth) { mSlopeFilter.setHalfWidth(halfWidth); }
+    int halfWidth() const { return mSlopeFilter.halfWidth(); }
+
+    // Derive all quantities from the raw samples in data. Ground and exit
+    // are filled into params if they were not given.
+    void process(DataPoints &data, Parameters &params) const;
+
+    // Recompute the parts of a processed track depending on each parameter
+    static void updateGround(DataPoints &data, double ground);
+    void updateVelocity(DataPoints &data, const Parameters &params) const;
+    void updateAerodynamics(DataPoints &data, const Parameters &params) const;
+
+    static DataPoint interpolateDataT(const DataPoints &data, double t);
+    static int findIndexBelowT(const DataPoints &data, double t);
+    static int findIndexAboveT(const DataPoints &data, double t);
+
+    static double getDistance(const DataPoint &dp1, const DataPoint &dp2,
+                              bool windAdjustment);
+    static double getBearing(const DataPoint &dp1, const DataPoint &dp2,
+                             bool windAdjustment);
+
+private:
+    SlopeFilter mSlopeFilter;
+
+    static void initTime(DataPoints &data, qint64 start);
+    static qint64 findExit(const DataPoints &data);
+    void initAcceleration(DataPoints &data) const;
+
+    void getSlopes(const DataPoints &data, int channels,
+                   double (* const *values)(const DataPoint &),
+                   QVector< double > *slopes) const;
+};
+
+#endif // TRACKPROCESSOR_H
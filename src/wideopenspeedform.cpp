@@ -21,6 +21,8 @@
 **  Website: http://flysight.ca/                                          **
 ****************************************************************************/
 
+#include <QDateTime>
+
 #include "wideopenspeedform.h"
 #include "ui_wideopenspeedform.h"
 
@@ -190,7 +192,7 @@ void WideOpenSpeedForm::updateView()
 
             if (dp.t <= dpBottom.t)
             {
-                ui->speedEdit->setText(dp.dateTime.toUTC().toString("hh:mm:ss.zzz"));
+                ui->speedEdit->setText(QDateTime::fromMSecsSinceEpoch(dp.timestamp, Qt::UTC).toString("hh:mm:ss.zzz"));
             }
             else
             {
@@ -111,23 +111,21 @@ void WindPlot::updatePlot()
     int start = mMainWindow->findIndexBelowT(lower) + 1;
     int end   = mMainWindow->findIndexAboveT(upper);
 
+    const TrackData &track = mMainWindow->track();
+
+    const double *tt = track.constData(TrackData::T);
+    const double *velE = track.constData(TrackData::VelE);
+    const double *velN = track.constData(TrackData::VelN);
+
+    const double factor = (mMainWindow->units() == PlotValue::Metric) ? MPS_TO_KMH : MPS_TO_MPH;
+
     bool first = true;
     for (int i = start; i < end; ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
+        t.append(tt[i]);
 
-        t.append(dp.t);
-
-        if (mMainWindow->units() == PlotValue::Metric)
-        {
-            x.append(dp.velE * MPS_TO_KMH);
-            y.append(dp.velN * MPS_TO_KMH);
-        }
-        else
-        {
-            x.append(dp.velE * MPS_TO_MPH);
-            y.append(dp.velN * MPS_TO_MPH);
-        }
+        x.append(velE[i] * factor);
+        y.append(velN[i] * factor);
 
         if (first)
         {
@@ -305,15 +303,18 @@ void WindPlot::updateWind(
     // Weighted least-squares circle fit based on this:
     //   http://www.dtcenter.org/met/users/docs/write_ups/circle_fit.pdf
 
+    const TrackData &track = mMainWindow->track();
+
+    const double *velE = track.constData(TrackData::VelE);
+    const double *velN = track.constData(TrackData::VelN);
+
     double xbar = 0, ybar = 0, N = 0;
     for (int i = start; i < end; ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
-
         const double wi = 1.0;
 
-        const double xi = dp.velE;
-        const double yi = dp.velN;
+        const double xi = velE[i];
+        const double yi = velN[i];
 
         xbar += wi * xi;
         ybar += wi * yi;
@@ -328,12 +329,10 @@ void WindPlot::updateWind(
     double suuu = 0, suvv = 0, svuu = 0, svvv = 0;
     for (int i = start; i < end; ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
-
         const double wi = 1.0;
 
-        const double xi = dp.velE;
-        const double yi = dp.velN;
+        const double xi = velE[i];
+        const double yi = velN[i];
 
         const double ui = xi - xbar;
         const double vi = yi - ybar;